@@ -0,0 +1,50 @@
+#include "ActionEncoder.h"
+#include <cstdio>
+#include <cstring>
+using namespace std;
+using namespace model;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+ActionEncoder::ActionEncoder() :
+    m_writer(m_line)
+{
+}
+
+string_view ActionEncoder::encode(const unordered_map<int, Action>& actions, const string& custom_rendering)
+{
+    m_line.Clear();
+    m_writer.Reset(m_line);
+    m_writer.StartObject();
+    for (const auto& item : actions)
+    {
+        char id[16];
+        const int length = snprintf(id, sizeof(id), "%d", item.first);
+        const Action& action = item.second;
+        m_writer.Key(id, (rapidjson::SizeType)length);
+        m_writer.StartObject();
+        m_writer.Key("target_velocity_x");
+        m_writer.Double(action.target_velocity_x);
+        m_writer.Key("target_velocity_y");
+        m_writer.Double(action.target_velocity_y);
+        m_writer.Key("target_velocity_z");
+        m_writer.Double(action.target_velocity_z);
+        m_writer.Key("jump_speed");
+        m_writer.Double(action.jump_speed);
+        m_writer.Key("use_nitro");
+        m_writer.Bool(action.use_nitro);
+        m_writer.EndObject();
+    }
+    m_writer.EndObject();
+
+    append("|", 1);
+    append(custom_rendering.data(), custom_rendering.size());
+    append("\n<end>\n", 7);
+    return string_view(m_line.GetString(), m_line.GetSize());
+}
+
+void ActionEncoder::append(const char* text, size_t length)
+{
+    memcpy(m_line.Push(length), text, length);
+}
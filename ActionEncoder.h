@@ -0,0 +1,38 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _ACTION_ENCODER_H_
+#define _ACTION_ENCODER_H_
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "model/Action.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Line with the actions of a tick for the server. The actions are written out field by field
+// straight into one buffer, the custom rendering is appended to it, no DOM and no string on
+// the way. The buffer keeps its memory, once it has grown to what a tick takes, encoding
+// allocates nothing. Same text as Action::to_json() in a Document would give.
+//
+class ActionEncoder
+{
+public:
+    ActionEncoder();
+
+    // Actions of the robots by id, '|', the custom rendering, "\n<end>\n".
+    // Valid until the next call.
+    std::string_view encode(const std::unordered_map<int, model::Action>& actions, const std::string& custom_rendering);
+
+private:
+    void append(const char* text, size_t length);
+
+    rapidjson::StringBuffer m_line;
+    rapidjson::Writer<rapidjson::StringBuffer> m_writer;
+};
+
+#endif // _ACTION_ENCODER_H_
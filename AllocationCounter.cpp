@@ -0,0 +1,73 @@
+#include "AllocationCounter.h"
+
+#ifdef MY_BENCHMARK
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> s_allocations(0);
+
+size_t AllocationCount()
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+
+//////////////////////////////////////////////////////////////////////////
+//
+// glibc lets a program define malloc itself, operator new comes here as well
+//
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+
+#else
+
+//////////////////////////////////////////////////////////////////////////
+//
+// The replaceable global operator new and delete, the rest of the forms
+// (arrays, nothrow) end up in these by default
+//
+void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+#endif
+
+#endif // MY_BENCHMARK
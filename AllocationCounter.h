@@ -0,0 +1,17 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _ALLOCATION_COUNTER_H_
+#define _ALLOCATION_COUNTER_H_
+
+#ifdef MY_BENCHMARK
+#include <cstddef>
+
+// Heap allocations made so far, a check takes the difference over the code it looks at.
+// With glibc malloc, calloc and realloc are counted, so rapidjson (which calls malloc itself)
+// is seen too. Elsewhere the global operator new is replaced and only it is counted.
+size_t AllocationCount();
+#endif
+
+#endif // _ALLOCATION_COUNTER_H_
@@ -0,0 +1,259 @@
+#include "ArenaModel.h"
+#include <algorithm>
+using namespace linal;
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+ArenaModel::ArenaModel(const model::Arena& arena) :
+    m_half_width((real_t)arena.width / 2.0_r),
+    m_height((real_t)arena.height),
+    m_half_depth((real_t)arena.depth / 2.0_r),
+    m_bottom_radius((real_t)arena.bottom_radius),
+    m_top_radius((real_t)arena.top_radius),
+    m_corner_radius((real_t)arena.corner_radius),
+    m_goal_top_radius((real_t)arena.goal_top_radius),
+    m_goal_half_width((real_t)arena.goal_width / 2.0_r),
+    m_goal_height((real_t)arena.goal_height),
+    m_goal_back((real_t)(arena.depth / 2.0 + arena.goal_depth)),
+    m_goal_side_radius((real_t)arena.goal_side_radius)
+{
+    const real_t curved_margin = max(m_corner_radius, max(m_bottom_radius, m_top_radius));
+    m_flat_x = m_half_width - max(m_bottom_radius, m_top_radius);
+    m_flat_z = m_half_depth - curved_margin;
+    m_flat_margin = max(m_bottom_radius, m_top_radius);
+    m_front_x = m_half_width - curved_margin;
+    m_front_z = m_half_depth - max(m_bottom_radius, m_top_radius);
+    m_tunnel_y = m_goal_height - m_goal_top_radius;
+    m_reach = min(m_bottom_radius, m_goal_top_radius);
+}
+
+// Within the reach the nested checks find the nearest surface, the contact of a body
+// that big is the distance to it.
+real_t ArenaModel::distance(const vec3& pos, vec3& normal) const
+{
+    const TouchInfo touch = collide(pos, m_reach);
+    normal = vec3() - touch.normal;
+    return m_reach - touch.depth;
+}
+
+// Contacts of the nested checks, the normals point from the object to the arena.
+inline TouchInfo touch_flat(real_t depth, const vec3& normal)
+{
+    TouchInfo ret;
+    if (depth > 0)
+    {
+        ret.depth = depth;
+        ret.normal = normal;
+    }
+    return ret;
+}
+
+// Object inside of a fillet, v goes from its center line to the object.
+inline TouchInfo touch_inner(const vec3& v, real_t fillet_radius, real_t radius)
+{
+    TouchInfo ret;
+    const real_t len = v.len();
+    if (len + radius - fillet_radius > 0)
+    {
+        ret.depth = len + radius - fillet_radius;
+        ret.normal = v / len;
+    }
+    return ret;
+}
+
+// Object outside of a rounded edge, v goes from the object to its center line.
+inline TouchInfo touch_outer(const vec3& v, real_t edge_radius, real_t radius)
+{
+    TouchInfo ret;
+    const real_t len = v.len();
+    if (radius + edge_radius - len > 0)
+    {
+        ret.depth = radius + edge_radius - len;
+        ret.normal = v / len;
+    }
+    return ret;
+}
+
+TouchInfo ArenaModel::collide_walls(const vec3& pos, real_t radius) const
+{
+    const real_t sx = copysign(1.0_r, pos.x);
+    const real_t sz = copysign(1.0_r, pos.z);
+    const vec3 p(pos.x * sx, pos.y, pos.z * sz);
+
+    TouchInfo ret = collide_nested(p, radius);
+    ret.normal.x *= sx;
+    ret.normal.z *= sz;
+    return ret;
+}
+
+// The nested checks of the old CheckArenaCollision, on the quarter. Each branch knows the
+// one surface a body there can touch.
+TouchInfo ArenaModel::collide_nested(const vec3& p, real_t radius) const
+{
+    const real_t br = m_bottom_radius;
+    const real_t tr = m_top_radius;
+    const real_t cr = m_corner_radius;
+    const real_t gtr = m_goal_top_radius;
+    const real_t gsr = m_goal_side_radius;
+    const real_t gw = m_goal_half_width;
+    const real_t mid = m_height / 2.0_r;
+
+    // Flat part of the side wall is between the fillets, pos_y is off its middle
+    const real_t wall_half = mid - (tr + br) / 2.0_r;
+    const real_t pos_y = p.y - (wall_half + br);
+
+    if (p.z <= m_half_depth - cr)
+    {
+        // Along the side wall
+        if (p.x <= m_half_width - tr)
+        {
+            const real_t dy = p.y - mid;
+            return touch_flat(abs(dy) + radius - mid, vec3(0.0_r, copysign(1.0_r, dy), 0.0_r));
+        }
+        if (abs(pos_y) <= wall_half)
+        {
+            return touch_flat(p.x + radius - m_half_width, vec3(1.0_r, 0.0_r, 0.0_r));
+        }
+        if (pos_y > 0)
+        {
+            return touch_inner(vec3(p.x - (m_half_width - tr), p.y - (m_height - tr), 0.0_r), tr, radius);
+        }
+        if (p.x < m_half_width - br)
+        {
+            return touch_flat(radius - p.y, vec3(0.0_r, -1.0_r, 0.0_r));
+        }
+        return touch_inner(vec3(p.x - (m_half_width - br), p.y - br, 0.0_r), br, radius);
+    }
+
+    if (p.x >= m_half_width - cr)
+    {
+        // Rounded corner of the field
+        const real_t nx = p.x - (m_half_width - cr);
+        const real_t nz = p.z - (m_half_depth - cr);
+        const real_t len = sqrt(nx * nx + nz * nz);
+        if (abs(pos_y) <= wall_half)
+        {
+            return touch_flat(len + radius - cr, vec3(nx / len, 0.0_r, nz / len));
+        }
+        if (pos_y > 0)
+        {
+            if (len < cr - tr)
+            {
+                return touch_flat(p.y + radius - m_height, vec3(0.0_r, 1.0_r, 0.0_r));
+            }
+            const real_t s = (len - (cr - tr)) / len;
+            return touch_inner(vec3(nx * s, p.y - (m_height - tr), nz * s), tr, radius);
+        }
+        if (len < cr - br)
+        {
+            return touch_flat(radius - p.y, vec3(0.0_r, -1.0_r, 0.0_r));
+        }
+        const real_t s = (len - (cr - br)) / len;
+        return touch_inner(vec3(nx * s, p.y - br, nz * s), br, radius);
+    }
+
+    if (p.y >= m_goal_height + gsr)
+    {
+        // Over the goal
+        if (p.y <= m_height - tr)
+        {
+            return touch_flat(p.z + radius - m_half_depth, vec3(0.0_r, 0.0_r, 1.0_r));
+        }
+        if (p.z <= m_half_depth - tr)
+        {
+            return touch_flat(p.y + radius - m_height, vec3(0.0_r, 1.0_r, 0.0_r));
+        }
+        return touch_inner(vec3(0.0_r, p.y - (m_height - tr), p.z - (m_half_depth - tr)), tr, radius);
+    }
+
+    if (p.z < m_half_depth - br)
+    {
+        return touch_flat(radius - p.y, vec3(0.0_r, -1.0_r, 0.0_r));
+    }
+
+    if (p.x >= gw + gsr)
+    {
+        // Next to the goal
+        if (p.y > br)
+        {
+            return touch_flat(p.z + radius - m_half_depth, vec3(0.0_r, 0.0_r, 1.0_r));
+        }
+        return touch_inner(vec3(0.0_r, p.y - br, p.z - (m_half_depth - br)), br, radius);
+    }
+
+    if (p.z <= m_half_depth + gsr)
+    {
+        // Goal mouth
+        if (p.x <= gw - gtr)
+        {
+            if (radius - p.y > 0)
+            {
+                return touch_flat(radius - p.y, vec3(0.0_r, -1.0_r, 0.0_r));
+            }
+            return touch_outer(vec3(0.0_r, m_goal_height + gsr - p.y, m_half_depth + gsr - p.z), gsr, radius);
+        }
+
+        const vec3 v(gw + gsr - p.x, 0.0_r, m_half_depth + gsr - p.z);
+        if (p.y < br)
+        {
+            const real_t len = v.len();
+            if (len > br + gsr)
+            {
+                return touch_flat(radius - p.y, vec3(0.0_r, -1.0_r, 0.0_r));
+            }
+            // Floor fillet around the goal post
+            const real_t s = (br + gsr) / len - 1.0_r;
+            return touch_inner(vec3(v.x * s, p.y - br, v.z * s), br, radius);
+        }
+        if (p.y <= m_goal_height - gtr)
+        {
+            return touch_outer(v, gsr, radius);
+        }
+
+        // Top corner, the torus around it. The old checks stopped here and missed
+        // the arena wall over the goal, it is the nearest once past the torus tube.
+        const real_t cx = p.x - (gw - gtr);
+        const real_t cy = p.y - (m_goal_height - gtr);
+        const real_t c_len = sqrt(cx * cx + cy * cy);
+        const real_t s = c_len - (gtr + gsr);
+        if (s >= 0)
+        {
+            return touch_flat(p.z + radius - m_half_depth, vec3(0.0_r, 0.0_r, 1.0_r));
+        }
+        return touch_outer(vec3(-cx * s / c_len, -cy * s / c_len, m_half_depth + gsr - p.z), gsr, radius);
+    }
+
+    // Inside the goal, dy is off the middle of its height
+    const real_t dy = p.y - m_goal_height / 2.0_r;
+    const real_t goal_flat_y = m_goal_height / 2.0_r - gtr;
+    const real_t sy = copysign(1.0_r, dy);
+    if (p.z <= m_goal_back - gtr)
+    {
+        if (p.x <= gw - gtr)
+        {
+            return touch_flat(abs(dy) + radius - m_goal_height / 2.0_r, vec3(0.0_r, sy, 0.0_r));
+        }
+        if (abs(dy) <= goal_flat_y)
+        {
+            return touch_flat(p.x + radius - gw, vec3(1.0_r, 0.0_r, 0.0_r));
+        }
+        return touch_inner(vec3(p.x - (gw - gtr), (abs(dy) - goal_flat_y) * sy, 0.0_r), gtr, radius);
+    }
+
+    const real_t back_z = p.z - (m_goal_back - gtr);
+    if (p.x <= gw - gtr)
+    {
+        if (abs(dy) <= goal_flat_y)
+        {
+            return touch_flat(p.z + radius - m_goal_back, vec3(0.0_r, 0.0_r, 1.0_r));
+        }
+        return touch_inner(vec3(0.0_r, (abs(dy) - goal_flat_y) * sy, back_z), gtr, radius);
+    }
+    if (abs(dy) <= goal_flat_y)
+    {
+        return touch_inner(vec3(p.x - (gw - gtr), 0.0_r, back_z), gtr, radius);
+    }
+    return touch_inner(vec3(p.x - (gw - gtr), (abs(dy) - goal_flat_y) * sy, back_z), gtr, radius);
+}
@@ -0,0 +1,125 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _ARENA_MODEL_H_
+#define _ARENA_MODEL_H_
+
+#include <algorithm>
+#include "linal.h"
+#include "model/Arena.h"
+using linal::operator""_r;
+
+struct TouchInfo
+{
+    linal::vec3 normal;            // from object to arena or from first object to second
+    linal::real_t depth = 0.0_r;   // penetration depth
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Arena collisions of the old CheckArenaCollision, built once from the full-size
+// model::Arena and evaluated on one x/z quarter, the result is mirrored back.
+// Nested region checks, each region knows the one surface a body there can touch.
+// They hold for the game arena, where the goal corners and the floor fillets share
+// one radius and the ceiling fillets are the largest ones, and for bodies up to reach().
+//
+class ArenaModel
+{
+public:
+    ArenaModel() {}
+    explicit ArenaModel(const model::Arena& arena);
+
+    // Distance from the point to the nearest arena surface, positive inside the arena.
+    // Normal points from the surface into the arena. Exact up to reach(), farther
+    // points get reach() and a zero normal.
+    linal::real_t distance(const linal::vec3& pos, linal::vec3& normal) const;
+
+    // Same contract as the old CheckArenaCollision: normal points from the object
+    // to the arena, depth is zero when there is no contact. Radius up to reach().
+    TouchInfo collide(const linal::vec3& pos, linal::real_t radius) const;
+
+    linal::real_t reach() const { return m_reach; }
+
+    // Only the floor or the ceiling can be within the radius, collide() takes its cheapest path.
+    bool open_field(const linal::vec3& pos, linal::real_t radius) const;
+
+    // A ball of the radius anywhere within the reach of pos in x/z and no higher than pos
+    // touches nothing but the floor: it is over the flat part of the floor in the field
+    // or in a goal and under the ceiling fillets.
+    bool floor_only(const linal::vec3& pos, linal::real_t radius, linal::real_t reach) const;
+
+private:
+    TouchInfo collide_walls(const linal::vec3& pos, linal::real_t radius) const;
+    TouchInfo collide_nested(const linal::vec3& p, linal::real_t radius) const;
+
+    linal::real_t m_half_width = 0.0_r;
+    linal::real_t m_height = 0.0_r;
+    linal::real_t m_half_depth = 0.0_r;
+    linal::real_t m_bottom_radius = 0.0_r;
+    linal::real_t m_top_radius = 0.0_r;
+    linal::real_t m_corner_radius = 0.0_r;
+    linal::real_t m_goal_top_radius = 0.0_r;
+    linal::real_t m_goal_half_width = 0.0_r;
+    linal::real_t m_goal_height = 0.0_r;
+    linal::real_t m_goal_back = 0.0_r;
+    linal::real_t m_goal_side_radius = 0.0_r;
+    // Nearest of the surfaces a region leaves out is never closer than this
+    linal::real_t m_reach = 0.0_r;
+    // Boxes with nothing but the floor and the ceiling inside, along the side walls and along the goal lines
+    linal::real_t m_flat_x = 0.0_r;
+    linal::real_t m_flat_z = 0.0_r;
+    linal::real_t m_flat_margin = 0.0_r;
+    linal::real_t m_front_x = 0.0_r;
+    linal::real_t m_front_z = 0.0_r;
+    // Under the goal top fillets
+    linal::real_t m_tunnel_y = 0.0_r;
+};
+
+// Open field check is inlined, that is where the ball and the robots spend most of the time.
+inline bool ArenaModel::open_field(const linal::vec3& pos, linal::real_t radius) const
+{
+    const linal::real_t ax = std::abs(pos.x);
+    const linal::real_t az = std::abs(pos.z);
+    return ((ax <= m_flat_x - radius) & (az <= m_flat_z - radius))
+        | ((ax <= m_front_x - radius) & (az <= m_front_z - radius));
+}
+
+// The bottom fillets start where the flat floor ends. From over the flat floor a ball
+// no bigger than them can not reach them at any height. The rounded field corners are left out.
+inline bool ArenaModel::floor_only(const linal::vec3& pos, linal::real_t radius, linal::real_t reach) const
+{
+    const linal::real_t ax = std::abs(pos.x) + reach;
+    const linal::real_t az = std::abs(pos.z) + reach;
+    const linal::real_t br = m_bottom_radius;
+    return (radius <= br) & (pos.y + radius <= std::min(m_tunnel_y, m_height - m_top_radius)) & (
+        ((ax <= m_half_width - br) & (az <= m_half_depth - m_corner_radius))
+        | ((ax <= m_half_width - m_corner_radius) & (az <= m_half_depth - br))
+        | ((ax <= m_goal_half_width - br) & (az <= m_goal_back - br)));
+}
+
+// The walls are at least the larger fillet radius away from the flat box, a body no bigger
+// than that can only touch the floor or the ceiling in there. One box and no radius to
+// subtract, it is cheaper than open_field().
+inline TouchInfo ArenaModel::collide(const linal::vec3& pos, linal::real_t radius) const
+{
+    if (!((std::abs(pos.x) <= m_flat_x) & (std::abs(pos.z) <= m_flat_z) & (radius <= m_flat_margin)))
+    {
+        return collide_walls(pos, radius);
+    }
+
+    // Only the floor or the ceiling can be within the radius
+    TouchInfo ret;
+    // Not |dy| + radius - height / 2, that one rounds away the last bits of a body resting on the floor
+    const linal::real_t dy = pos.y - m_height / 2.0_r;
+    ret.depth = radius - std::min(pos.y, m_height - pos.y);
+    if (ret.depth > 0)
+    {
+        ret.normal.y = std::copysign(1.0_r, dy);
+        return ret;
+    }
+    ret.depth = 0.0_r;
+    return ret;
+}
+
+#endif // _ARENA_MODEL_H_
@@ -0,0 +1,316 @@
+#include "BallTrajectory.h"
+#include <algorithm>
+#include <cmath>
+using namespace linal;
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+BallTrajectory::BallTrajectory(const Simulator& sim, int horizon) :
+    m_sim(&sim),
+    m_timestep(sim.timestep()),
+    m_gravity(sim.gravity()),
+    m_goal_line(sim.goal_line())
+{
+    set_horizon(horizon);
+}
+
+void BallTrajectory::reset(const Entity& ball, int tick)
+{
+    m_segments.clear();
+    Segment seg;
+    seg.tick = tick;
+    seg.start = ball;
+    m_segments.push_back(seg);
+    m_first_tick = tick;
+    m_last_tick = tick;
+}
+
+void BallTrajectory::grow(int tick)
+{
+    tick = min(tick, horizon_tick());
+    while (m_last_tick < tick && !m_segments.empty())
+    {
+        const Segment& last = m_segments.back();
+        const Entity ball = state(last, (real_t)(m_last_tick - last.tick));
+
+        // In a goal the ball is not predicted any further
+        Kind kind = Still;
+        int ticks = tick - m_last_tick;
+        if (abs(ball.pos.z) < m_goal_line)
+        {
+            bool rolling = false;
+            ticks = m_sim->free_ticks(ball, ticks, rolling);
+            kind = rolling ? Rolling : Flight;
+            if (ticks > 0 && ball.vel.z != 0)
+            {
+                // Ends at the first tick in a goal
+                const real_t cross = (copysign(m_goal_line, ball.vel.z) - ball.pos.z) / (ball.vel.z * m_timestep);
+                ticks = (int)min((real_t)ticks, max(1.0_r, ceil(cross)));
+            }
+        }
+
+        if (0 == ticks)
+        {
+            // A contact on the way, the state after it starts a new segment
+            Segment next;
+            next.tick = m_last_tick + 1;
+            next.start = m_sim->tick_alone(ball);
+            m_segments.push_back(next);
+            ++m_last_tick;
+            ++m_stats.predicted;
+            ++m_stats.stepped;
+            continue;
+        }
+
+        if (last.tick == m_last_tick)
+        {
+            // Nothing but the start state yet
+            m_segments.back().kind = kind;
+        }
+        else if (last.kind != kind)
+        {
+            Segment next;
+            next.tick = m_last_tick;
+            next.kind = kind;
+            next.start = ball;
+            m_segments.push_back(next);
+        }
+        m_last_tick += ticks;
+        m_stats.predicted += ticks;
+    }
+}
+
+void BallTrajectory::forget(int tick)
+{
+    m_segments.erase(m_segments.begin(), m_segments.begin() + find(tick));
+    m_first_tick = max(m_first_tick, tick);
+}
+
+static real_t error(const Entity& a, const Entity& b)
+{
+    return max(a.pos.dist(b.pos), a.vel.dist(b.vel));
+}
+
+int BallTrajectory::correct(const Entity& ball, int tick, real_t match, real_t rejoin)
+{
+    grow(tick);
+    const real_t off = (m_segments.empty() || m_last_tick < tick) ? rejoin + 1.0_r : error(at(tick), ball);
+    if (off <= match)
+    {
+        return -1;
+    }
+    if (off > rejoin)
+    {
+        ++m_stats.resets;
+        reset(ball, tick);
+        return tick;
+    }
+
+    // Simulated again from the observed state, checked against the old prediction at every old segment start
+    const size_t current = find(tick);
+    const int old_last = m_last_tick;
+    m_old.assign(m_segments.begin() + current, m_segments.end());
+    m_segments.resize(current);
+    Segment anchor;
+    anchor.tick = tick;
+    anchor.start = ball;
+    m_segments.push_back(anchor);
+    m_last_tick = tick;
+
+    for (size_t i = 1; i < m_old.size(); ++i)
+    {
+        const Segment& old = m_old[i];
+        grow(old.tick);
+        if (m_last_tick < old.tick || error(at(old.tick), old.start) > rejoin)
+        {
+            // Went off on the way, the rest of the old prediction is no good
+            ++m_stats.missed;
+            return first_off(tick, old.tick, rejoin);
+        }
+
+        // Back on the old prediction, the old segments from here on stay
+        while (m_segments.back().tick >= old.tick)
+        {
+            m_segments.pop_back();
+        }
+        m_segments.insert(m_segments.end(), m_old.begin() + i, m_old.end());
+        m_last_tick = old_last;
+        ++m_stats.anchored;
+        m_stats.reused += old_last - old.tick + 1;
+        return -1;
+    }
+
+    // No old contact left, the new prediction goes as far as the old one did
+    grow(old_last);
+    const Segment& old = m_old.back();
+    if (error(at(old_last), state(old, (real_t)(old_last - old.tick))) > rejoin)
+    {
+        ++m_stats.missed;
+        return first_off(tick, old_last, rejoin);
+    }
+    ++m_stats.anchored;
+    return -1;
+}
+
+// The two only agreed at the checks, the first tick off may be anywhere after from.
+// The old prediction is what correct() keeps in m_old.
+int BallTrajectory::first_off(int from, int to, real_t rejoin) const
+{
+    size_t old = 0;
+    for (int tick = from + 1; tick < to; ++tick)
+    {
+        while (old + 1 < m_old.size() && m_old[old + 1].tick <= tick)
+        {
+            ++old;
+        }
+        if (tick > m_last_tick || error(at(tick), state(m_old[old], (real_t)(tick - m_old[old].tick))) > rejoin)
+        {
+            return tick;
+        }
+    }
+    return to;
+}
+
+BallTrajectory::Stats& BallTrajectory::Stats::operator+=(const Stats& other)
+{
+    predicted += other.predicted;
+    stepped += other.stepped;
+    reused += other.reused;
+    anchored += other.anchored;
+    missed += other.missed;
+    resets += other.resets;
+    return *this;
+}
+
+void BallTrajectory::reset_stats()
+{
+    m_totals += m_stats;
+    m_stats = Stats();
+}
+
+size_t BallTrajectory::find(int tick) const
+{
+    auto it = upper_bound(m_segments.begin(), m_segments.end(), tick, [](int t, const Segment& seg) { return t < seg.tick; });
+    return (it == m_segments.begin()) ? 0 : (size_t)(it - m_segments.begin()) - 1;
+}
+
+Entity BallTrajectory::state(const Segment& seg, real_t ticks) const
+{
+    Entity ret = seg.start;
+    const real_t t = ticks * m_timestep;
+    switch (seg.kind)
+    {
+    case Flight:
+        ret.pos += ret.vel * t;
+        ret.pos.y -= m_gravity * t * t / 2.0_r;
+        ret.vel.y -= m_gravity * t;
+        break;
+    case Rolling:
+        ret.pos.x += ret.vel.x * t;
+        ret.pos.z += ret.vel.z * t;
+        break;
+    case Still:
+        break;
+    }
+    return ret;
+}
+
+Entity BallTrajectory::at(int tick) const
+{
+    if (m_segments.empty())
+    {
+        return Entity();
+    }
+
+    tick = min(max(tick, first_tick()), m_last_tick);
+    const Segment& seg = m_segments[find(tick)];
+    return state(seg, (real_t)(tick - seg.tick));
+}
+
+// Roots of c + q*s + w*s*s
+static int roots(real_t c, real_t q, real_t w, real_t* out)
+{
+    if (w == 0)
+    {
+        if (q == 0)
+        {
+            return 0;
+        }
+        out[0] = -c / q;
+        return 1;
+    }
+
+    const real_t disc = q * q - 4.0_r * w * c;
+    if (disc < 0)
+    {
+        return 0;
+    }
+    const real_t root = sqrt(disc);
+    out[0] = (-q - root) / (2.0_r * w);
+    out[1] = (-q + root) / (2.0_r * w);
+    return 2;
+}
+
+int BallTrajectory::first_entry(const Box& box, int from) const
+{
+    from = max(from, first_tick());
+    for (size_t i = find(from); i < m_segments.size(); ++i)
+    {
+        const Segment& seg = m_segments[i];
+        const int end = (i + 1 < m_segments.size()) ? m_segments[i + 1].tick - 1 : m_last_tick;
+        const real_t lo = (real_t)(max(from, seg.tick) - seg.tick);
+        const real_t hi = (real_t)(end - seg.tick);
+        if (lo > hi)
+        {
+            continue;
+        }
+
+        // Each coordinate is c + q*s + w*s*s in ticks since the segment start
+        const real_t t = m_timestep;
+        const bool moving = (seg.kind != Still);
+        const real_t c[3] = { seg.start.pos.x, seg.start.pos.y, seg.start.pos.z };
+        const real_t q[3] = {
+            moving ? seg.start.vel.x * t : 0.0_r,
+            (seg.kind == Flight) ? seg.start.vel.y * t : 0.0_r,
+            moving ? seg.start.vel.z * t : 0.0_r };
+        const real_t w[3] = { 0.0_r, (seg.kind == Flight) ? -m_gravity * t * t / 2.0_r : 0.0_r, 0.0_r };
+        const real_t bounds[2][3] = {
+            { box.min.x, box.min.y, box.min.z },
+            { box.max.x, box.max.y, box.max.z } };
+
+        // The ball only gets in where it crosses a side of the box, so the first tick inside
+        // is the first one of the segment or right at (or after, by rounding) a crossing
+        real_t cuts[13];
+        int count = 0;
+        cuts[count++] = lo;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (int side = 0; side < 2; ++side)
+            {
+                count += roots(c[axis] - bounds[side][axis], q[axis], w[axis], cuts + count);
+            }
+        }
+        for (int j = 0; j < count; ++j)
+        {
+            cuts[j] = min(max(cuts[j], lo), hi);
+        }
+        sort(cuts, cuts + count);
+
+        int tried = -1;
+        for (int j = 0; j < count; ++j)
+        {
+            const int k0 = (int)ceil(cuts[j]);
+            for (int k = max(k0, tried + 1); k <= min(k0 + 1, (int)hi); ++k)
+            {
+                tried = k;
+                if (box.contains(state(seg, (real_t)k).pos))
+                {
+                    return seg.tick + k;
+                }
+            }
+        }
+    }
+    return -1;
+}
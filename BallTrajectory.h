@@ -0,0 +1,139 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _BALL_TRAJECTORY_H_
+#define _BALL_TRAJECTORY_H_
+
+#include <vector>
+#include <algorithm>
+#include "linal.h"
+#include "World.h"
+#include "Simulator.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Predicted ball path as analytic pieces between contacts: a parabola in flight,
+// a straight line rolling on the floor, a still point once the ball is in a goal.
+// Ticks with a contact go through Simulator::tick_alone and start a new piece, so
+// the states are the same as ticking the ball one tick after another.
+// Ticks are absolute game ticks. The prediction only grows as far as somebody asks,
+// see sample(), and never past the horizon.
+//
+class BallTrajectory
+{
+public:
+    enum Kind
+    {
+        Flight,
+        Rolling,
+        Still
+    };
+
+    struct Segment
+    {
+        int tick = 0;                   // the first tick, the segment lasts until the next one starts
+        Kind kind = Flight;
+        Entity start;                   // ball state at that tick
+    };
+
+    // Box for first_entry(), the defaults leave it open on every side
+    struct Box
+    {
+        linal::vec3 min = linal::vec3(-1e6_r, -1e6_r, -1e6_r);
+        linal::vec3 max = linal::vec3(1e6_r, 1e6_r, 1e6_r);
+
+        bool contains(const linal::vec3& pos) const;
+    };
+
+    // Ticks the prediction made, for the counters
+    struct Stats
+    {
+        int predicted = 0;              // ticks added to the prediction
+        int stepped = 0;                // of them, ticks with a contact stepped by Simulator::tick_alone
+        int reused = 0;                 // ticks of the old prediction kept by correct()
+        int anchored = 0;               // corrections made by re-anchoring
+        int missed = 0;                 // re-anchorings that did not get back onto the old prediction
+        int resets = 0;                 // corrections that started over
+
+        Stats& operator+=(const Stats& other);
+    };
+
+    BallTrajectory() {}
+    explicit BallTrajectory(const Simulator& sim, int horizon = 100);
+
+    // Starts over from the ball state at the tick
+    void reset(const Entity& ball, int tick);
+
+    // Predicts up to the tick, but not past the horizon
+    void grow(int tick);
+
+    // Drops the segments over before the tick, the horizon moves along
+    void forget(int tick);
+
+    // Puts the observed ball state at the tick into the prediction.
+    // Within match of the prediction nothing changes. Within rejoin the prediction is re-anchored:
+    // it is simulated again from the observed state only up to a start of an old segment (the
+    // next contact, usually) where both agree within rejoin, the old segments from there on are kept.
+    // Anything else starts over. Returns the first tick predicted off by more than rejoin, -1 if none.
+    int correct(const Entity& ball, int tick, linal::real_t match, linal::real_t rejoin);
+
+    // How many ticks from first_tick() on may be predicted
+    void set_horizon(int ticks) { m_horizon = std::max(ticks, 1); }
+    int horizon() const { return m_horizon; }
+
+    int first_tick() const { return m_first_tick; }
+    int last_tick() const { return m_last_tick; }
+    int horizon_tick() const { return m_first_tick + m_horizon - 1; }
+
+    // Ball state at the tick, clamped to [first_tick(), last_tick()]: a tick past last_tick()
+    // gets the last state predicted, check predicted() where that matters
+    Entity at(int tick) const;
+    bool predicted(int tick) const { return (tick >= m_first_tick) & (tick <= m_last_tick); }
+
+    // Same, but grows the prediction up to the tick first
+    Entity sample(int tick)
+    {
+        grow(tick);
+        return at(tick);
+    }
+
+    // First tick from the given one on with the ball center inside the box, -1 if it does not get
+    // there within the prediction made so far (grow() it first to look further).
+    // Takes a few root solves per segment, not a look at every tick.
+    int first_entry(const Box& box, int from) const;
+
+    // Counters since reset_stats(), totals() sums up all of them before
+    const Stats& stats() const { return m_stats; }
+    const Stats& totals() const { return m_totals; }
+    void reset_stats();
+
+    const std::vector<Segment>& segments() const { return m_segments; }
+
+private:
+    size_t find(int tick) const;
+    int first_off(int from, int to, linal::real_t rejoin) const;
+    Entity state(const Segment& seg, linal::real_t ticks) const;
+
+    const Simulator* m_sim = nullptr;
+    linal::real_t m_timestep = 0.0_r;
+    linal::real_t m_gravity = 0.0_r;
+    linal::real_t m_goal_line = 0.0_r;
+
+    std::vector<Segment> m_segments;
+    std::vector<Segment> m_old;         // correct() scratch, the segments being replaced
+    int m_horizon = 100;
+    int m_first_tick = 0;
+    int m_last_tick = 0;
+    Stats m_stats;
+    Stats m_totals;
+};
+
+inline bool BallTrajectory::Box::contains(const linal::vec3& pos) const
+{
+    return (pos.x >= min.x) & (pos.x <= max.x)
+        & (pos.y >= min.y) & (pos.y <= max.y)
+        & (pos.z >= min.z) & (pos.z <= max.z);
+}
+
+#endif // _BALL_TRAJECTORY_H_
@@ -0,0 +1,2988 @@
+#include "Benchmark.h"
+
+#ifdef MY_BENCHMARK
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "model/Rules.h"
+#include "model/Game.h"
+#include "linal.h"
+#include "ArenaModel.h"
+#include "Simulator.h"
+#include "World.h"
+#include "WorldState.h"
+#include "BallTrajectory.h"
+#include "JumpArc.h"
+#include "LineBuffer.h"
+#include "JsonDecoder.h"
+#include "ActionEncoder.h"
+#include "AllocationCounter.h"
+#include "BinaryProtocol.h"
+#include "RemoteProcessClient.h"
+#include "Runner.h"
+#include "MyStrategy.h"
+#include "ThreadPool.h"
+#include "StandInServer.h"
+#include "csimplesocket/PassiveSocket.h"
+using namespace linal;
+using namespace std;
+using namespace model;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+static const char* s_default_rules = R"___({
+  "max_tick_count": 18000,
+  "arena": {
+    "width": 60.0, "height": 20.0, "depth": 80.0,
+    "bottom_radius": 3.0, "top_radius": 7.0, "corner_radius": 13.0,
+    "goal_top_radius": 3.0, "goal_width": 30.0, "goal_height": 10.0,
+    "goal_depth": 10.0, "goal_side_radius": 1.0
+  },
+  "team_size": 2,
+  "seed": 1,
+  "ROBOT_MIN_RADIUS": 1.0,
+  "ROBOT_MAX_RADIUS": 1.05,
+  "ROBOT_MAX_JUMP_SPEED": 15.0,
+  "ROBOT_ACCELERATION": 100.0,
+  "ROBOT_NITRO_ACCELERATION": 30.0,
+  "ROBOT_MAX_GROUND_SPEED": 30.0,
+  "ROBOT_ARENA_E": 0.0,
+  "ROBOT_RADIUS": 1.0,
+  "ROBOT_MASS": 2.0,
+  "TICKS_PER_SECOND": 60,
+  "MICROTICKS_PER_TICK": 100,
+  "RESET_TICKS": 120,
+  "BALL_ARENA_E": 0.7,
+  "BALL_RADIUS": 2.0,
+  "BALL_MASS": 1.0,
+  "MIN_HIT_E": 0.4,
+  "MAX_HIT_E": 0.5,
+  "MAX_ENTITY_SPEED": 100.0,
+  "MAX_NITRO_AMOUNT": 100.0,
+  "START_NITRO_AMOUNT": 50.0,
+  "NITRO_POINT_VELOCITY_CHANGE": 0.6,
+  "NITRO_PACK_X": 20.0,
+  "NITRO_PACK_Y": 1.0,
+  "NITRO_PACK_Z": 30.0,
+  "NITRO_PACK_RADIUS": 0.5,
+  "NITRO_PACK_AMOUNT": 100.0,
+  "NITRO_PACK_RESPAWN_TICKS": 600,
+  "GRAVITY": 30.0
+})___";
+
+struct Stopwatch
+{
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+    double ns() const
+    {
+        return (double)chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+// Keeps the optimizer from dropping benchmarked computations.
+static volatile double s_sink = 0.0;
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Every vec3 operation over arrays of random vectors, for comparing the linal backends
+//
+template <typename Op>
+static void TimeVecOp(const char* name, const vector<vec3>& a, const vector<vec3>& b, const vector<real_t>& k, vector<vec3>& out, Op op)
+{
+    const int rounds = 2000;
+    Stopwatch sw;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            out[i] = op(a[i], b[i], k[i]);
+        }
+        s_sink = s_sink + out[round % out.size()].x;
+    }
+    printf("linal %-12s %.2f ns\n", name, sw.ns() / rounds / a.size());
+}
+
+static void BenchLinal(const Rules&)
+{
+    mt19937 rng(20181223);
+    uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+    const size_t count = 1024;
+    vector<vec3> a(count), b(count), out(count);
+    vector<real_t> k(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = vec3(unit(rng), unit(rng), unit(rng)) * 30.0_r;
+        b[i] = vec3(unit(rng), unit(rng), unit(rng)) * 30.0_r;
+        k[i] = 1.0_r + abs(unit(rng)) * 30.0_r;
+    }
+
+#ifdef LINAL_FAST_RSQRT
+    printf("linal backend %s, fast rsqrt with %d steps\n", simd::name, LINAL_RSQRT_STEPS);
+#else
+    printf("linal backend %s\n", simd::name);
+#endif
+    TimeVecOp("a + b", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return a + b; });
+    TimeVecOp("a - b", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return a - b; });
+    TimeVecOp("a * b", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return a * b; });
+    TimeVecOp("a / b", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return a / b; });
+    TimeVecOp("a * k", a, b, k, out, [](const vec3& a, const vec3&, real_t k) { return a * k; });
+    TimeVecOp("a / k", a, b, k, out, [](const vec3& a, const vec3&, real_t k) { return a / k; });
+    TimeVecOp("-a", a, b, k, out, [](const vec3& a, const vec3&, real_t) { vec3 v = a; return -v; });
+    TimeVecOp("dot", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return vec3(a.dot(b)); });
+    TimeVecOp("len", a, b, k, out, [](const vec3& a, const vec3&, real_t) { return vec3(a.len()); });
+    TimeVecOp("dist", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return vec3(a.dist(b)); });
+    TimeVecOp("normal", a, b, k, out, [](const vec3& a, const vec3&, real_t) { return a.normal(); });
+    TimeVecOp("normalize", a, b, k, out, [](const vec3& a, const vec3&, real_t) { vec3 v = a; return v.normalize(); });
+    TimeVecOp("clamp", a, b, k, out, [](const vec3& a, const vec3&, real_t k) { vec3 v = a; return v.clamp(k); });
+    TimeVecOp("vec3::clamp", a, b, k, out, [](const vec3& a, const vec3&, real_t k) { return vec3::clamp(a, k); });
+    TimeVecOp("project", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { return a.project(b); });
+    TimeVecOp("deviation", a, b, k, out, [](const vec3& a, const vec3& b, real_t) { vec3 v = a; return vec3(v.deviation(b)); });
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Reference copy of the nested-if collision check ArenaModel replaced.
+// Works on the half-size arena the strategy used to keep in s_rules.
+//
+struct LegacyBody
+{
+    vec3 pos;
+    real_t radius = 0.0_r;
+};
+
+static inline real_t sign(real_t v)
+{
+    return v / abs(v);
+}
+
+static TouchInfo LegacyArenaCollision(const Arena& s_arena, const LegacyBody& e)
+{
+    static vec3 simple_box(
+        (real_t)(s_arena.width - s_arena.top_radius)
+        , (real_t)(s_arena.height)
+        , real_t(s_arena.depth - s_arena.corner_radius)
+    );
+
+    TouchInfo ret;
+
+    if (abs(e.pos.z) <= simple_box.z)
+    {
+        if (abs(e.pos.x) <= simple_box.x)
+        {
+            ret.normal.y = e.pos.y - simple_box.y;
+            ret.depth = abs(ret.normal.y) + e.radius - simple_box.y;
+            ret.normal.y /= abs(ret.normal.y);
+            if (ret.depth > 0)
+            {
+                return ret;
+            }
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        real_t size_y = s_arena.height - (s_arena.top_radius + s_arena.bottom_radius) / 2.0_r;
+        real_t pos_y = e.pos.y - (size_y + s_arena.bottom_radius);
+        if (abs(pos_y) <= size_y)
+        {
+            ret.depth = abs(e.pos.x) + e.radius - s_arena.width;
+            if (ret.depth > 0)
+            {
+                ret.normal.x = sign(e.pos.x);
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (pos_y > 0)
+        {
+            ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.top_radius)) * sign(e.pos.x);
+            ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
+            ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
+            if (ret.depth > 0)
+            {
+                ret.normal.normalize();
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (abs(e.pos.x) < (s_arena.width - s_arena.bottom_radius))
+        {
+            ret.depth = e.radius - e.pos.y;
+            if (ret.depth > 0)
+            {
+                ret.normal.y = -1.0_r;
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.bottom_radius)) * sign(e.pos.x);
+        ret.normal.y = e.pos.y - s_arena.bottom_radius;
+        ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(e.pos.x) >= (s_arena.width - s_arena.corner_radius))
+    {
+        real_t size_y = s_arena.height - (s_arena.top_radius + s_arena.bottom_radius) / 2.0_r;
+        real_t pos_y = e.pos.y - (size_y + s_arena.bottom_radius);
+        ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.corner_radius)) * sign(e.pos.x);
+        ret.normal.z = (abs(e.pos.z) - simple_box.z) * sign(e.pos.z);
+        ret.normal.y = ret.normal.len();
+        if (abs(pos_y) <= size_y)
+        {
+            ret.depth = ret.normal.y + e.radius - s_arena.corner_radius;
+            if (ret.depth > 0)
+            {
+                ret.normal.x /= ret.normal.y;
+                ret.normal.z /= ret.normal.y;
+                ret.normal.y = 0.0_r;
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (pos_y > 0)
+        {
+            if (ret.normal.y < (s_arena.corner_radius - s_arena.top_radius))
+            {
+                ret.depth = e.pos.y + e.radius - s_arena.height * 2.0_r;
+                if (ret.depth > 0)
+                {
+                    ret.normal = vec3(0.0_r, 1.0_r, 0.0_r);
+                    return ret;
+                }
+
+                ret.depth = 0.0_r;
+                return ret;
+            }
+
+            size_y = ret.normal.y;
+            ret.normal.y = 0.0_r;
+            ret.normal = ret.normal.normal() * (size_y - (s_arena.corner_radius - s_arena.top_radius));
+            ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
+            ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
+            if (ret.depth > 0)
+            {
+                ret.normal.normalize();
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (ret.normal.y < (s_arena.corner_radius - s_arena.bottom_radius))
+        {
+            ret.depth = e.radius - e.pos.y;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        size_y = ret.normal.y;
+        ret.normal.y = 0.0_r;
+        ret.normal = ret.normal.normal() * (size_y - (s_arena.corner_radius - s_arena.bottom_radius));
+        ret.normal.y = e.pos.y - s_arena.bottom_radius;
+        ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (e.pos.y >= (s_arena.goal_height + s_arena.goal_side_radius))
+    {
+        if (e.pos.y <= (s_arena.height * 2.0_r - s_arena.top_radius))
+        {
+            ret.depth = abs(e.pos.z) + e.radius - s_arena.depth;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (abs(e.pos.z) <= (s_arena.depth - s_arena.top_radius))
+        {
+            ret.depth = e.pos.y + e.radius - s_arena.height * 2.0_r;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, 1.0_r, 0.0_r);
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.z = (abs(e.pos.z) - (s_arena.depth - s_arena.top_radius)) * sign(e.pos.z);
+        ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
+        ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(e.pos.z) < (s_arena.depth - s_arena.bottom_radius))
+    {
+        ret.depth = e.radius - e.pos.y;
+        if (ret.depth > 0)
+        {
+            ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(e.pos.x) >= (s_arena.goal_width / 2.0_r + s_arena.goal_side_radius))
+    {
+        if (e.pos.y > s_arena.bottom_radius)
+        {
+            ret.depth = abs(e.pos.z) + e.radius - s_arena.depth;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.y = e.pos.y - s_arena.bottom_radius;
+        ret.normal.z = (abs(e.pos.z) - (s_arena.depth - s_arena.bottom_radius)) * sign(e.pos.z);
+        ret.depth = e.radius + ret.normal.len() - s_arena.bottom_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(e.pos.z) <= (s_arena.depth + s_arena.goal_side_radius))
+    {
+        if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
+        {
+            ret.depth = e.radius - e.pos.y;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
+                return ret;
+            }
+
+            ret.normal.y = (s_arena.goal_height + s_arena.goal_side_radius) - e.pos.y;
+            ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius)- abs(e.pos.z)) * sign(e.pos.z);
+            ret.depth = (e.radius + s_arena.goal_side_radius) - ret.normal.len();
+            if (ret.depth > 0)
+            {
+                ret.normal.normalize();
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.x = ((s_arena.goal_width / 2.0_r + s_arena.goal_side_radius) - abs(e.pos.x)) * sign(e.pos.x);
+        ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius) - abs(e.pos.z)) * sign(e.pos.z);
+        ret.depth = ret.normal.len();
+        if (e.pos.y < s_arena.bottom_radius)
+        {
+            if (ret.depth > (s_arena.bottom_radius + s_arena.goal_side_radius))
+            {
+                ret.depth = e.radius - e.pos.y;
+                if (ret.depth > 0)
+                {
+                    ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
+                    return ret;
+                }
+
+                ret.depth = 0.0_r;
+                return ret;
+            }
+
+            ret.normal = -ret.normal.normal() * (s_arena.bottom_radius + s_arena.goal_side_radius);
+            ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r + s_arena.goal_side_radius + ret.normal.x * sign(e.pos.x))) * sign(e.pos.x);
+            ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_side_radius + ret.normal.z * sign(e.pos.z))) * sign(e.pos.z);
+            ret.normal.y = e.pos.y - s_arena.bottom_radius;
+            ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
+            if (ret.depth > 0)
+            {
+                ret.normal.normalize();
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (e.pos.y <= (s_arena.goal_height - s_arena.goal_top_radius))
+        {
+            ret.depth = e.radius + s_arena.goal_side_radius - ret.depth;
+            if (ret.depth > 0)
+            {
+                ret.normal.normalize();
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
+        ret.normal.y = e.pos.y - (s_arena.goal_height - s_arena.goal_top_radius);
+        ret.normal.z = 0.0_r;
+        ret.normal = ret.normal.normal() * (s_arena.goal_top_radius + s_arena.goal_side_radius);
+
+        ret.normal.x = ((s_arena.goal_width / 2.0_r - s_arena.goal_top_radius + ret.normal.x * sign(e.pos.x)) - abs(e.pos.x)) * sign(e.pos.x);
+        ret.normal.y = (s_arena.goal_height - s_arena.goal_top_radius + ret.normal.y) - e.pos.y;
+        ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius) - abs(e.pos.z)) * sign(e.pos.z);
+        ret.depth = e.radius + s_arena.goal_side_radius - ret.normal.len();
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    ret.normal.y = e.pos.y - s_arena.goal_height / 2.0_r;
+
+    if (abs(e.pos.z) <= (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius))
+    {
+        if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
+        {
+            ret.depth = abs(ret.normal.y) + e.radius - s_arena.goal_height / 2.0_r;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, sign(ret.normal.y), 0.0_r);
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
+        {
+            ret.depth = abs(e.pos.x) + e.radius - s_arena.goal_width / 2.0_r;
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(sign(e.pos.x), 0.0_r, 0.0_r);
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
+        ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
+        ret.normal.z = 0.0_r;
+        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
+    {
+        if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
+        {
+            ret.depth = abs(e.pos.z) + e.radius - (s_arena.depth + s_arena.goal_depth);
+            if (ret.depth > 0)
+            {
+                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
+                return ret;
+            }
+
+            ret.depth = 0.0_r;
+            return ret;
+        }
+
+        ret.normal.x = 0.0_r;
+        ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
+        ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
+        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
+    {
+        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
+        ret.normal.y = 0.0_r;
+        ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
+        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
+        if (ret.depth > 0)
+        {
+            ret.normal.normalize();
+            return ret;
+        }
+
+        ret.depth = 0.0_r;
+        return ret;
+    }
+
+    ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
+    ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
+    ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
+    ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
+    if (ret.depth > 0)
+    {
+        ret.normal.normalize();
+        return ret;
+    }
+
+    ret.depth = 0.0_r;
+    return ret;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Reference distance to the arena, the official dan_to_arena as the game rules give it:
+// every primitive of the quarter min-reduced, nothing skipped. Slow and plain on purpose.
+//
+struct ReferenceDan
+{
+    real_t distance;
+    vec3 normal;
+};
+
+static void ReferenceMin(ReferenceDan& dan, real_t distance, const vec3& normal)
+{
+    if (distance < dan.distance)
+    {
+        dan.distance = distance;
+        dan.normal = normal;
+    }
+}
+
+static void ReferencePlane(ReferenceDan& dan, const vec3& p, const vec3& on_plane, const vec3& normal)
+{
+    ReferenceMin(dan, (p - on_plane).dot(normal), normal);
+}
+
+static void ReferenceSphereInner(ReferenceDan& dan, const vec3& p, const vec3& center, real_t radius)
+{
+    ReferenceMin(dan, radius - (p - center).len(), (center - p).normal());
+}
+
+static void ReferenceSphereOuter(ReferenceDan& dan, const vec3& p, const vec3& center, real_t radius)
+{
+    ReferenceMin(dan, (p - center).len() - radius, (p - center).normal());
+}
+
+static ReferenceDan ReferenceArenaQuarter(const Arena& a, const vec3& p)
+{
+    const real_t w = (real_t)a.width / 2.0_r, d = (real_t)a.depth / 2.0_r, h = (real_t)a.height;
+    const real_t gw = (real_t)a.goal_width / 2.0_r, gh = (real_t)a.goal_height, gd = (real_t)a.goal_depth;
+    const real_t br = (real_t)a.bottom_radius, tr = (real_t)a.top_radius, cr = (real_t)a.corner_radius;
+    const real_t gtr = (real_t)a.goal_top_radius, gsr = (real_t)a.goal_side_radius;
+
+    ReferenceDan dan;
+    dan.distance = p.y;
+    dan.normal = vec3(0.0_r, 1.0_r, 0.0_r);
+    ReferencePlane(dan, p, vec3(0.0_r, h, 0.0_r), vec3(0.0_r, -1.0_r, 0.0_r));
+    ReferencePlane(dan, p, vec3(w, 0.0_r, 0.0_r), vec3(-1.0_r, 0.0_r, 0.0_r));
+    ReferencePlane(dan, p, vec3(0.0_r, 0.0_r, d + gd), vec3(0.0_r, 0.0_r, -1.0_r));
+
+    {
+        const vec2 v = vec2(p.x, p.y) - vec2(gw - gtr, gh - gtr);
+        if (p.x >= gw + gsr || p.y >= gh + gsr || (v.x > 0 && v.y > 0 && v.len() >= gtr + gsr))
+        {
+            ReferencePlane(dan, p, vec3(0.0_r, 0.0_r, d), vec3(0.0_r, 0.0_r, -1.0_r));
+        }
+    }
+    if (p.z >= d + gsr)
+    {
+        ReferencePlane(dan, p, vec3(gw, 0.0_r, 0.0_r), vec3(-1.0_r, 0.0_r, 0.0_r));
+        ReferencePlane(dan, p, vec3(0.0_r, gh, 0.0_r), vec3(0.0_r, -1.0_r, 0.0_r));
+    }
+    if (p.z > d + gd - br)
+    {
+        ReferenceSphereInner(dan, p, vec3(min(max(p.x, br - gw), gw - br), min(max(p.y, br), gh - gtr), d + gd - br), br);
+    }
+    if (p.x > w - cr && p.z > d - cr)
+    {
+        ReferenceSphereInner(dan, p, vec3(w - cr, p.y, d - cr), cr);
+    }
+    if (p.z < d + gsr)
+    {
+        if (p.x < gw + gsr)
+        {
+            ReferenceSphereOuter(dan, p, vec3(gw + gsr, p.y, d + gsr), gsr);
+        }
+        if (p.y < gh + gsr)
+        {
+            ReferenceSphereOuter(dan, p, vec3(p.x, gh + gsr, d + gsr), gsr);
+        }
+        vec2 o(gw - gtr, gh - gtr);
+        const vec2 v = vec2(p.x, p.y) - o;
+        if (v.x > 0 && v.y > 0)
+        {
+            o = o + v.normal() * (gtr + gsr);
+            ReferenceSphereOuter(dan, p, vec3(o.x, o.y, d + gsr), gsr);
+        }
+    }
+    if (p.z > d + gsr && p.y > gh - gtr)
+    {
+        if (p.x > gw - gtr)
+        {
+            ReferenceSphereInner(dan, p, vec3(gw - gtr, gh - gtr, p.z), gtr);
+        }
+        if (p.z > d + gd - gtr)
+        {
+            ReferenceSphereInner(dan, p, vec3(p.x, gh - gtr, d + gd - gtr), gtr);
+        }
+    }
+    if (p.y < br)
+    {
+        if (p.x > w - br)
+        {
+            ReferenceSphereInner(dan, p, vec3(w - br, br, p.z), br);
+        }
+        if (p.z > d - br && p.x >= gw + gsr)
+        {
+            ReferenceSphereInner(dan, p, vec3(p.x, br, d - br), br);
+        }
+        if (p.z > d + gd - br)
+        {
+            ReferenceSphereInner(dan, p, vec3(p.x, br, d + gd - br), br);
+        }
+        vec2 o(gw + gsr, d + gsr);
+        const vec2 v = vec2(p.x, p.z) - o;
+        if (v.x < 0 && v.y < 0 && v.len() < gsr + br)
+        {
+            o = o + v.normal() * (gsr + br);
+            ReferenceSphereInner(dan, p, vec3(o.x, br, o.y), br);
+        }
+        if (p.z >= d + gsr && p.x > gw - br)
+        {
+            ReferenceSphereInner(dan, p, vec3(gw - br, br, p.z), br);
+        }
+        if (p.x > w - cr && p.z > d - cr)
+        {
+            const vec2 corner(w - cr, d - cr);
+            const vec2 n = vec2(p.x, p.z) - corner;
+            if (n.len() > cr - br)
+            {
+                const vec2 o2 = corner + n.normal() * (cr - br);
+                ReferenceSphereInner(dan, p, vec3(o2.x, br, o2.y), br);
+            }
+        }
+    }
+    if (p.y > h - tr)
+    {
+        if (p.x > w - tr)
+        {
+            ReferenceSphereInner(dan, p, vec3(w - tr, h - tr, p.z), tr);
+        }
+        if (p.z > d - tr)
+        {
+            ReferenceSphereInner(dan, p, vec3(p.x, h - tr, d - tr), tr);
+        }
+        if (p.x > w - cr && p.z > d - cr)
+        {
+            const vec2 corner(w - cr, d - cr);
+            const vec2 n = vec2(p.x, p.z) - corner;
+            if (n.len() > cr - tr)
+            {
+                const vec2 o2 = corner + n.normal() * (cr - tr);
+                ReferenceSphereInner(dan, p, vec3(o2.x, h - tr, o2.y), tr);
+            }
+        }
+    }
+    return dan;
+}
+
+// Full-size arena
+static ReferenceDan ReferenceArena(const Arena& arena, const vec3& pos)
+{
+    const real_t sx = (pos.x < 0) ? -1.0_r : 1.0_r;
+    const real_t sz = (pos.z < 0) ? -1.0_r : 1.0_r;
+    ReferenceDan dan = ReferenceArenaQuarter(arena, vec3(pos.x * sx, pos.y, pos.z * sz));
+    dan.normal.x *= sx;
+    dan.normal.z *= sz;
+    return dan;
+}
+
+// collide() out of the reference distance
+static TouchInfo ReferenceCollide(const Arena& arena, const vec3& pos, real_t radius)
+{
+    const ReferenceDan dan = ReferenceArena(arena, pos);
+    TouchInfo ret;
+    if (radius - dan.distance > 0)
+    {
+        ret.depth = radius - dan.distance;
+        ret.normal = vec3() - dan.normal;
+    }
+    return ret;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+static vector<vec3> ArenaSamplePositions(const ArenaModel& model, real_t radius, size_t count)
+{
+    mt19937 rng(20181218);
+    uniform_real_distribution<real_t> x(-30.0_r, 30.0_r);
+    uniform_real_distribution<real_t> y(0.0_r, 20.0_r);
+    uniform_real_distribution<real_t> z(-50.0_r, 50.0_r);
+
+    vector<vec3> ret;
+    ret.reserve(count);
+    while (ret.size() < count)
+    {
+        vec3 pos(x(rng), y(rng), z(rng));
+        vec3 normal;
+        // Only positions a body of this radius can actually reach
+        if (model.distance(pos, normal) > radius * 0.5_r)
+        {
+            ret.push_back(pos);
+        }
+    }
+    return ret;
+}
+
+// Positions the ball tick asks the arena about: one query per free-flight tick
+// and a query per microtick for the ticks with a contact, in simulation order.
+static vector<vec3> ArenaBallQueries(const ArenaModel& model, const Rules& rules, size_t count)
+{
+    mt19937 rng(20181219);
+    uniform_real_distribution<real_t> x(-25.0_r, 25.0_r);
+    uniform_real_distribution<real_t> y(2.0_r, 15.0_r);
+    uniform_real_distribution<real_t> z(-35.0_r, 35.0_r);
+    uniform_real_distribution<real_t> v(-40.0_r, 40.0_r);
+
+    const real_t radius = (real_t)rules.BALL_RADIUS;
+    const real_t gravity = (real_t)rules.GRAVITY;
+    const real_t arena_e = (real_t)rules.BALL_ARENA_E;
+    const real_t timestep = 1.0_r / (real_t)rules.TICKS_PER_SECOND;
+    const real_t microstep = timestep / (real_t)rules.MICROTICKS_PER_TICK;
+
+    vector<vec3> ret;
+    ret.reserve(count + rules.MICROTICKS_PER_TICK);
+    while (ret.size() < count)
+    {
+        vec3 pos(x(rng), y(rng), z(rng));
+        vec3 vel(v(rng), v(rng) / 2.0_r, v(rng));
+        for (int tick = 0; tick < 300 && ret.size() < count; ++tick)
+        {
+            vec3 next_pos = pos + vel * timestep;
+            next_pos.y -= gravity * timestep * timestep / 2.0_r;
+            ret.push_back(next_pos);
+            if (model.collide(next_pos, radius).depth <= 0)
+            {
+                pos = next_pos;
+                vel.y -= gravity * timestep;
+                continue;
+            }
+
+            for (int utick = 0; utick < rules.MICROTICKS_PER_TICK; ++utick)
+            {
+                pos += vel * microstep;
+                pos.y -= gravity * microstep * microstep / 2.0_r;
+                vel.y -= gravity * microstep;
+                ret.push_back(pos);
+                TouchInfo touch = model.collide(pos, radius);
+                if (touch.depth > 0)
+                {
+                    pos -= touch.normal * touch.depth;
+                    real_t vn = vel.dot(touch.normal);
+                    if (vn > 0)
+                    {
+                        vel -= touch.normal * (1.0_r + arena_e) * vn;
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+struct TouchErrors
+{
+    size_t touches = 0;
+    size_t depth_mismatches = 0;
+    size_t normal_mismatches = 0;
+    real_t max_depth_error = 0.0_r;
+    real_t max_normal_error = 0.0_r;
+
+    void add(const TouchInfo& expected, const TouchInfo& touch)
+    {
+        real_t depth_error = abs(expected.depth - touch.depth);
+        max_depth_error = max(max_depth_error, depth_error);
+        if (depth_error > 1e-9_r)
+        {
+            ++depth_mismatches;
+        }
+        if (touch.depth > 0 && expected.depth > 0)
+        {
+            ++touches;
+            real_t normal_error = expected.normal.dist(touch.normal);
+            max_normal_error = max(max_normal_error, normal_error);
+            if (normal_error > 1e-9_r)
+            {
+                ++normal_mismatches;
+            }
+        }
+    }
+
+    void print(const char* name, const char* against) const
+    {
+        printf("arena %s: vs %s depth mismatches %zu (max error %g), normal mismatches %zu (max error %g)\n"
+            , name, against, depth_mismatches, (double)max_depth_error, normal_mismatches, (double)max_normal_error);
+    }
+};
+
+// The model against the reference on a dense grid over the whole arena, points outside of it left out.
+// The grid is shifted off the round coordinates, there two surfaces tie and either normal is right.
+// Past its reach the model only has to say so.
+static void CompareArenaDistance(const Arena& arena, const ArenaModel& model, real_t step)
+{
+    size_t points = 0, mismatches = 0, normal_mismatches = 0;
+    real_t max_error = 0.0_r;
+    vec3 worst;
+    for (real_t x = -31.0_r + step * 0.3183_r; x <= 31.0_r; x += step)
+    {
+        for (real_t y = step * 0.5772_r; y <= 20.0_r; y += step)
+        {
+            for (real_t z = -51.0_r + step * 0.1415_r; z <= 51.0_r; z += step)
+            {
+                const vec3 pos(x, y, z);
+                const ReferenceDan dan = ReferenceArena(arena, pos);
+                if (dan.distance < 0)
+                {
+                    continue;
+                }
+                ++points;
+                vec3 normal;
+                const real_t error = abs(model.distance(pos, normal) - min(dan.distance, model.reach()));
+                if (error > 1e-9_r)
+                {
+                    ++mismatches;
+                }
+                else if (dan.distance < model.reach() && normal.dist(dan.normal) > 1e-6_r)
+                {
+                    ++normal_mismatches;
+                }
+                if (error > max_error)
+                {
+                    max_error = error;
+                    worst = pos;
+                }
+            }
+        }
+    }
+    printf("arena distance: %zu points inside, mismatches %zu (max error %g at %.2f %.2f %.2f), normal mismatches %zu\n"
+        , points, mismatches, (double)max_error, (double)worst.x, (double)worst.y, (double)worst.z, normal_mismatches);
+}
+
+static void CompareArenaCollision(const char* name, const Arena& arena, const Arena& half_arena, const ArenaModel& model, const vector<vec3>& positions, real_t radius)
+{
+    TouchErrors legacy_errors, reference_errors;
+    for (auto& pos : positions)
+    {
+        LegacyBody body;
+        body.pos = pos;
+        body.radius = radius;
+        TouchInfo touch = model.collide(pos, radius);
+        legacy_errors.add(LegacyArenaCollision(half_arena, body), touch);
+        reference_errors.add(ReferenceCollide(arena, pos, radius), touch);
+    }
+
+    printf("arena %s: %zu positions, %zu touching\n", name, positions.size(), reference_errors.touches);
+    reference_errors.print(name, "reference");
+    legacy_errors.print(name, "legacy");
+
+    const int rounds = 20;
+    double legacy_ns = 0.0, model_ns = 0.0;
+    for (int round = 0; round < rounds; ++round)
+    {
+        {
+            Stopwatch sw;
+            real_t sum = 0.0_r;
+            LegacyBody body;
+            body.radius = radius;
+            for (auto& pos : positions)
+            {
+                body.pos = pos;
+                sum += LegacyArenaCollision(half_arena, body).depth;
+            }
+            legacy_ns += sw.ns();
+            s_sink = s_sink + sum;
+        }
+        {
+            Stopwatch sw;
+            real_t sum = 0.0_r;
+            for (auto& pos : positions)
+            {
+                sum += model.collide(pos, radius).depth;
+            }
+            model_ns += sw.ns();
+            s_sink = s_sink + sum;
+        }
+    }
+
+    const double calls = (double)positions.size() * rounds;
+    printf("arena %s: legacy %.2f ns/call, model %.2f ns/call, speedup x%.2f\n"
+        , name, legacy_ns / calls, model_ns / calls, legacy_ns / model_ns);
+}
+
+static void BenchArenaModel(const Rules& rules)
+{
+    Arena half_arena = rules.arena;
+    half_arena.width /= 2.0;
+    half_arena.height /= 2.0;
+    half_arena.depth /= 2.0;
+
+    const real_t radius = (real_t)rules.BALL_RADIUS;
+    ArenaModel model(rules.arena);
+
+    CompareArenaDistance(rules.arena, model, 0.25_r);
+    CompareArenaCollision("scatter", rules.arena, half_arena, model, ArenaSamplePositions(model, radius, 1 << 18), radius);
+    CompareArenaCollision("ball ticks", rules.arena, half_arena, model, ArenaBallQueries(model, rules, 1 << 18), radius);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+// Kickoff-like world: the ball in the air and both teams on the floor
+static World BenchWorld(const Rules& rules, mt19937& rng)
+{
+    uniform_real_distribution<real_t> x(-20.0_r, 20.0_r);
+    uniform_real_distribution<real_t> z(-30.0_r, 30.0_r);
+    uniform_real_distribution<real_t> v(-20.0_r, 20.0_r);
+
+    World world;
+    world.ball.pos = vec3(x(rng), 2.0_r * (real_t)rules.BALL_RADIUS + 5.0_r, z(rng) / 2.0_r);
+    world.ball.vel = vec3(v(rng), v(rng) / 2.0_r, v(rng));
+    world.ball.radius = (real_t)rules.BALL_RADIUS;
+    world.ball.mass = (real_t)rules.BALL_MASS;
+    world.ball.arena_e = (real_t)rules.BALL_ARENA_E;
+
+    for (int id = 1; id <= 2 * rules.team_size; ++id)
+    {
+        Entity& bot = world.bots[world.add_bot(id, id <= rules.team_size)];
+        bot.pos = vec3(x(rng), (real_t)rules.ROBOT_RADIUS, z(rng));
+        bot.radius = (real_t)rules.ROBOT_RADIUS;
+        bot.mass = (real_t)rules.ROBOT_MASS;
+        bot.arena_e = (real_t)rules.ROBOT_ARENA_E;
+        bot.normal = vec3(0.0_r, 1.0_r, 0.0_r);
+        bot.touch = true;
+    }
+    return world;
+}
+
+// Random actions, every robot runs somewhere and now and then jumps
+static void BenchActions(const Rules& rules, World& world, mt19937& rng)
+{
+    uniform_real_distribution<real_t> v(-(real_t)rules.ROBOT_MAX_GROUND_SPEED, (real_t)rules.ROBOT_MAX_GROUND_SPEED);
+    uniform_int_distribution<int> jump(0, 15);
+
+    for (int i = 0; i < world.bot_count; ++i)
+    {
+        Entity& bot = world.bots[i];
+        bot.target_vel = vec3(v(rng), 0.0_r, v(rng));
+        bot.jump_speed = (0 == jump(rng)) ? (real_t)rules.ROBOT_MAX_JUMP_SPEED : 0.0_r;
+        bot.use_nitro = false;
+    }
+}
+
+// What the server sends of the world, the first team is ours
+static void WorldGame(const World& world, int tick, Game& game)
+{
+    game.current_tick = tick;
+    game.players.resize(2);
+    for (int i = 0; i < 2; ++i)
+    {
+        game.players[i].id = i + 1;
+        game.players[i].me = (0 == i);
+        game.players[i].strategy_crashed = false;
+        game.players[i].score = 0;
+    }
+    game.robots.resize(world.bot_count);
+    for (int i = 0; i < world.bot_count; ++i)
+    {
+        const Entity& bot = world.bots[i];
+        Robot& robot = game.robots[i];
+        robot.id = world.ids[i];
+        robot.is_teammate = (i < world.teammates);
+        robot.player_id = robot.is_teammate ? 1 : 2;
+        robot.x = bot.pos.x, robot.y = bot.pos.y, robot.z = bot.pos.z;
+        robot.velocity_x = bot.vel.x, robot.velocity_y = bot.vel.y, robot.velocity_z = bot.vel.z;
+        robot.radius = bot.radius;
+        robot.nitro_amount = bot.nitro;
+        robot.touch = bot.touch;
+        robot.touch_normal_x = bot.touch ? bot.normal.x : 0.0;
+        robot.touch_normal_y = bot.touch ? bot.normal.y : 0.0;
+        robot.touch_normal_z = bot.touch ? bot.normal.z : 0.0;
+    }
+    game.nitro_packs.clear();
+    game.ball.x = world.ball.pos.x, game.ball.y = world.ball.pos.y, game.ball.z = world.ball.pos.z;
+    game.ball.velocity_x = world.ball.vel.x, game.ball.velocity_y = world.ball.vel.y, game.ball.velocity_z = world.ball.vel.z;
+    game.ball.radius = world.ball.radius;
+}
+
+// The strategy's answers into the robots of the world
+static void WorldActions(const unordered_map<int, Action>& actions, World& world)
+{
+    for (auto& it : actions)
+    {
+        const int slot = world.slot(it.first);
+        if (slot < 0)
+        {
+            continue;
+        }
+        Entity& bot = world.bots[slot];
+        bot.target_vel = vec3((real_t)it.second.target_velocity_x, (real_t)it.second.target_velocity_y, (real_t)it.second.target_velocity_z);
+        bot.jump_speed = (real_t)it.second.jump_speed;
+        bot.use_nitro = it.second.use_nitro;
+    }
+}
+
+static void BenchSimulator(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    mt19937 rng(20181220);
+
+    const int worlds = 200;
+    const int ticks = 100;
+    int simulated = 0;
+    double world_ns = 0.0;
+    for (int i = 0; i < worlds; ++i)
+    {
+        World world = BenchWorld(rules, rng);
+        for (int tick = 0; tick < ticks && 0 == world.goal; ++tick)
+        {
+            BenchActions(rules, world, rng);
+            Stopwatch sw;
+            sim.tick(world);
+            world_ns += sw.ns();
+            ++simulated;
+        }
+        s_sink = s_sink + world.ball.pos.y;
+    }
+    printf("sim world (%d robots): %.2f us/tick, %.0f ticks/s, %.0f microticks/s\n"
+        , 2 * rules.team_size, world_ns / simulated / 1e3, simulated * 1e9 / world_ns
+        , (double)simulated * rules.MICROTICKS_PER_TICK * 1e9 / world_ns);
+
+    simulated = 0;
+    Stopwatch sw;
+    for (int i = 0; i < worlds; ++i)
+    {
+        Entity ball = BenchWorld(rules, rng).ball;
+        for (int tick = 0; tick < ticks * 10; ++tick)
+        {
+            ball = sim.tick_alone(ball);
+            ++simulated;
+        }
+        s_sink = s_sink + ball.pos.y;
+    }
+    const double ball_ns = sw.ns();
+    printf("sim ball alone: %.2f ns/tick, %.0f ticks/s\n", ball_ns / simulated, simulated * 1e9 / ball_ns);
+
+    // Two robots jumping into each other high in the air, standing still otherwise. Both radius
+    // change speeds add to the approach speed, the hit sends each one off at (1 + e) * jump speed.
+    {
+        World pair;
+        for (int id = 1; id <= 2; ++id)
+        {
+            Entity& bot = pair.bots[pair.add_bot(id, true)];
+            bot.pos = vec3((id == 1 ? -1.0_r : 1.0_r) * ((real_t)rules.ROBOT_RADIUS - 0.05_r), 10.0_r, 0.0_r);
+            bot.radius = (real_t)rules.ROBOT_RADIUS;
+            bot.mass = (real_t)rules.ROBOT_MASS;
+            bot.arena_e = (real_t)rules.ROBOT_ARENA_E;
+            bot.jump_speed = (real_t)rules.ROBOT_MAX_JUMP_SPEED;
+        }
+        pair.ball.pos = vec3(0.0_r, 10.0_r, 20.0_r);
+        pair.ball.radius = (real_t)rules.BALL_RADIUS;
+        pair.ball.mass = (real_t)rules.BALL_MASS;
+        pair.ball.arena_e = (real_t)rules.BALL_ARENA_E;
+        sim.tick(pair);
+
+        const real_t hit_e = (real_t)(rules.MIN_HIT_E + rules.MAX_HIT_E) / 2.0_r;
+        const real_t expected = 2.0_r * (1.0_r + hit_e) * (real_t)rules.ROBOT_MAX_JUMP_SPEED;
+        const real_t separation = pair.bots[1].vel.x - pair.bots[0].vel.x;
+        printf("sim jumping robots: separate at %.4f, the rules give %.4f%s\n"
+            , (double)separation, (double)expected, abs(separation - expected) > 1e-9_r ? " MISMATCH" : "");
+    }
+
+    // Cloning worlds the way a search would, the flat World against the robots kept in a map by id
+    const World world = BenchWorld(rules, rng);
+    map<int, Entity> tree;
+    for (int i = 0; i < world.bot_count; ++i)
+    {
+        tree[world.ids[i]] = world.bots[i];
+    }
+    const int clones = 100000;
+    vector<World> copies(64);
+    Stopwatch flat_sw;
+    for (int i = 0; i < clones; ++i)
+    {
+        copies[i & 63] = world;
+    }
+    const double flat_ns = flat_sw.ns();
+    vector<map<int, Entity>> tree_copies(64);
+    Stopwatch tree_sw;
+    for (int i = 0; i < clones; ++i)
+    {
+        tree_copies[i & 63] = tree;
+    }
+    const double tree_ns = tree_sw.ns();
+    Stopwatch clone_sw;
+    for (int i = 0; i < clones; ++i)
+    {
+        map<int, Entity> clone(tree);
+        s_sink = s_sink + clone.begin()->second.pos.y;
+    }
+    const double clone_ns = clone_sw.ns();
+    s_sink = s_sink + copies[clones & 63].ball.pos.y + tree_copies[clones & 63].begin()->second.pos.y;
+    printf("sim world copy (%d bytes): %.1f ns, robots in a map %.1f ns reusing the nodes, %.1f ns into a new map\n"
+        , (int)sizeof(World), flat_ns / clones, tree_ns / clones, clone_ns / clones);
+}
+
+// Ball starts for the tick benchmarks: high in the middle, all over the arena with a fast
+// bouncing ball, and on the floor with the vertical speed rolling converges to.
+static vector<Entity> BallStarts(const Rules& rules, const char* scenario, size_t count)
+{
+    mt19937 rng(20181221);
+    uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+
+    Entity ball;
+    ball.radius = (real_t)rules.BALL_RADIUS;
+    ball.mass = (real_t)rules.BALL_MASS;
+    ball.arena_e = (real_t)rules.BALL_ARENA_E;
+    const real_t g_dt = (real_t)rules.GRAVITY / (real_t)rules.TICKS_PER_SECOND / (real_t)rules.MICROTICKS_PER_TICK;
+
+    vector<Entity> ret(count, ball);
+    for (auto& e : ret)
+    {
+        if (0 == strcmp(scenario, "free flight"))
+        {
+            e.pos = vec3(unit(rng) * 10.0_r, 12.0_r + unit(rng) * 2.0_r, unit(rng) * 15.0_r);
+            e.vel = vec3(unit(rng) * 10.0_r, 8.0_r + unit(rng) * 2.0_r, unit(rng) * 10.0_r);
+        }
+        else if (0 == strcmp(scenario, "bouncing"))
+        {
+            e.pos = vec3(unit(rng) * 25.0_r, 10.0_r + unit(rng) * 7.0_r, unit(rng) * 35.0_r);
+            e.vel = vec3(unit(rng) * 30.0_r, unit(rng) * 15.0_r, unit(rng) * 30.0_r);
+        }
+        else
+        {
+            e.pos = vec3(unit(rng) * 10.0_r, e.radius, unit(rng) * 15.0_r);
+            e.vel = vec3(unit(rng) * 10.0_r, e.arena_e * g_dt / (1.0_r + e.arena_e), unit(rng) * 10.0_r);
+        }
+    }
+    return ret;
+}
+
+static void BenchBallTicks(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    const struct { const char* scenario; int ticks; size_t count; } runs[] = {
+        { "free flight", 30, 2000 },
+        { "bouncing", 30, 2000 },
+        { "rolling", 30, 2000 },
+        // Bouncing ball left alone until it rolls and slides along the walls
+        { "settling", 1000, 100 },
+    };
+
+    for (auto& run : runs)
+    {
+        const char* scenario = run.scenario;
+        const int ticks = run.ticks;
+        const vector<Entity> starts = BallStarts(rules, 0 == strcmp(scenario, "settling") ? "bouncing" : scenario, run.count);
+
+        // Errors of a single tick, both sides start from the same microtick state
+        real_t pos_error = 0.0_r, vel_error = 0.0_r;
+        for (auto& start : starts)
+        {
+            Entity e = start;
+            for (int tick = 0; tick < ticks; ++tick)
+            {
+                const Entity adaptive = sim.tick_alone(e);
+                e = sim.tick_alone_microticks(e);
+                pos_error = max(pos_error, adaptive.pos.dist(e.pos));
+                vel_error = max(vel_error, adaptive.vel.dist(e.vel));
+            }
+        }
+
+        double ns[2];
+        for (int adaptive = 0; adaptive < 2; ++adaptive)
+        {
+            Stopwatch sw;
+            for (auto& start : starts)
+            {
+                Entity e = start;
+                for (int tick = 0; tick < ticks; ++tick)
+                {
+                    e = adaptive ? sim.tick_alone(e) : sim.tick_alone_microticks(e);
+                }
+                s_sink = s_sink + e.pos.y;
+            }
+            ns[adaptive] = sw.ns();
+        }
+
+        const double count = (double)starts.size() * ticks;
+        printf("ticks %s: microticks %.0f ticks/s, adaptive %.0f ticks/s, x%.1f, max error pos %.2e vel %.2e\n"
+            , scenario, count * 1e9 / ns[0], count * 1e9 / ns[1], ns[0] / ns[1], pos_error, vel_error);
+    }
+
+    // Robot running on the floor, the old StepMove loop against the closed form
+    mt19937 rng(20181222);
+    uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+    const real_t max_speed = (real_t)rules.ROBOT_MAX_GROUND_SPEED;
+    const real_t step_dv = (real_t)rules.ROBOT_ACCELERATION / (real_t)rules.TICKS_PER_SECOND / (real_t)rules.MICROTICKS_PER_TICK;
+    vector<vec3> targets(4096);
+    for (auto& target : targets)
+    {
+        target = vec3::clamp(vec3(unit(rng), 0.0_r, unit(rng)) * max_speed, max_speed);
+    }
+
+    real_t pos_error = 0.0_r, vel_error = 0.0_r;
+    double ns[2] = { 0.0, 0.0 };
+    for (int adaptive = 0; adaptive < 2; ++adaptive)
+    {
+        vec3 pos, vel;
+        Stopwatch sw;
+        for (int round = 0; round < 10; ++round)
+        {
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                // A few ticks towards every target, the first ones accelerate, the rest run
+                const vec3& target = targets[(i / 8) * 8];
+                if (adaptive)
+                {
+                    sim.ground_tick(pos, vel, target);
+                    continue;
+                }
+                for (int utick = 0; utick < rules.MICROTICKS_PER_TICK; ++utick)
+                {
+                    vel += vec3::clamp(target - vel, step_dv);
+                    vel.clamp(max_speed);
+                    pos += vel * sim.microstep();
+                }
+            }
+        }
+        ns[adaptive] = sw.ns();
+        s_sink = s_sink + pos.x;
+    }
+
+    vec3 pos, vel;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const vec3& target = targets[(i / 8) * 8];
+        vec3 ref_pos = pos, ref_vel = vel;
+        for (int utick = 0; utick < rules.MICROTICKS_PER_TICK; ++utick)
+        {
+            ref_vel += vec3::clamp(target - ref_vel, step_dv);
+            ref_vel.clamp(max_speed);
+            ref_pos += ref_vel * sim.microstep();
+        }
+        sim.ground_tick(pos, vel, target);
+        pos_error = max(pos_error, pos.dist(ref_pos));
+        vel_error = max(vel_error, vel.dist(ref_vel));
+        pos = ref_pos;
+        vel = ref_vel;
+    }
+
+    const double count = (double)targets.size() * 10;
+    printf("ticks ground run: microticks %.0f ticks/s, closed form %.0f ticks/s, x%.1f, max error pos %.2e vel %.2e\n"
+        , count * 1e9 / ns[0], count * 1e9 / ns[1], ns[0] / ns[1], pos_error, vel_error);
+}
+
+// The old BallTick ring buffer: tick by tick, the ball stays put once in a goal
+static void TickByTick(const Simulator& sim, const Entity& ball, vector<Entity>& ticks)
+{
+    ticks[0] = ball;
+    for (size_t i = 1; i < ticks.size(); ++i)
+    {
+        ticks[i] = (abs(ticks[i - 1].pos.z) >= sim.goal_line()) ? ticks[i - 1] : sim.tick_alone(ticks[i - 1]);
+    }
+}
+
+static void BenchBallTrajectory(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    BallTrajectory path(sim);
+    const int horizon = 100;
+
+    // Ball low enough for a robot to jump at it, and in the own half
+    BallTrajectory::Box boxes[2];
+    boxes[0].max.y = (real_t)(rules.ROBOT_MAX_JUMP_SPEED * rules.ROBOT_MAX_JUMP_SPEED / rules.GRAVITY / 2.0 + rules.BALL_RADIUS);
+    boxes[1].max.z = -(real_t)rules.arena.depth / 4.0_r;
+
+    for (const char* scenario : { "free flight", "bouncing", "rolling" })
+    {
+        const vector<Entity> starts = BallStarts(rules, scenario, 1000);
+        vector<Entity> ticks(horizon);
+
+        // Every sample and every entry against the tick by tick prediction. The same prediction
+        // asked for in pieces of random length, as the planners do, has to come out bit for bit the same.
+        mt19937 rng(20181225);
+        uniform_int_distribution<int> piece(1, 30);
+        BallTrajectory pieces(sim);
+        real_t pos_error = 0.0_r, vel_error = 0.0_r;
+        size_t segments = 0, entry_mismatches = 0, piece_mismatches = 0;
+        for (auto& start : starts)
+        {
+            TickByTick(sim, start, ticks);
+            path.reset(start, 0);
+            path.grow(horizon - 1);
+            segments += path.segments().size();
+            pieces.reset(start, 0);
+            for (int tick = 0; tick < horizon - 1; tick += piece(rng))
+            {
+                pieces.grow(tick);
+            }
+            pieces.grow(horizon - 1);
+            for (int i = 0; i < horizon; ++i)
+            {
+                const Entity a = path.at(i), b = pieces.at(i);
+                if (memcmp(&a.pos, &b.pos, sizeof(vec3)) || memcmp(&a.vel, &b.vel, sizeof(vec3)))
+                {
+                    ++piece_mismatches;
+                    break;
+                }
+            }
+            for (int i = 0; i < horizon; ++i)
+            {
+                pos_error = max(pos_error, path.at(i).pos.dist(ticks[i].pos));
+                vel_error = max(vel_error, path.at(i).vel.dist(ticks[i].vel));
+            }
+            for (auto& box : boxes)
+            {
+                for (int from = 0; from < horizon; from += 10)
+                {
+                    int entry = from;
+                    while (entry < horizon && !box.contains(ticks[entry].pos))
+                    {
+                        ++entry;
+                    }
+                    entry_mismatches += (path.first_entry(box, from) != (entry < horizon ? entry : -1));
+                }
+            }
+        }
+
+        Stopwatch sw;
+        for (auto& start : starts)
+        {
+            TickByTick(sim, start, ticks);
+            s_sink = s_sink + ticks.back().pos.y;
+        }
+        const double tick_ns = sw.ns() / starts.size();
+
+        double build_ns = 0.0, at_ns = 0.0, entry_ns = 0.0, scan_ns = 0.0;
+        for (auto& start : starts)
+        {
+            Stopwatch build;
+            path.reset(start, 0);
+            path.grow(horizon - 1);
+            build_ns += build.ns();
+
+            Stopwatch samples;
+            real_t sum = 0.0_r;
+            for (int i = 0; i < horizon; ++i)
+            {
+                sum += path.at(i).pos.y;
+            }
+            at_ns += samples.ns() / horizon;
+
+            Stopwatch entries;
+            for (auto& box : boxes)
+            {
+                sum += (real_t)path.first_entry(box, 0);
+            }
+            entry_ns += entries.ns() / 2.0;
+
+            // What the callers did before, sample after sample until the ball is in
+            Stopwatch scans;
+            for (auto& box : boxes)
+            {
+                int entry = 0;
+                while (entry < horizon && !box.contains(path.at(entry).pos))
+                {
+                    ++entry;
+                }
+                sum += (real_t)entry;
+            }
+            scan_ns += scans.ns() / 2.0;
+            s_sink = s_sink + sum;
+        }
+
+        const double count = (double)starts.size();
+        printf("trajectory %s: %.1f segments per %d ticks, max error pos %.2e vel %.2e, %zu entry mismatches, %zu grown in pieces differ%s\n"
+            , scenario, segments / count, horizon, pos_error, vel_error, entry_mismatches, piece_mismatches, piece_mismatches ? " FAILED" : "");
+        printf("trajectory %s: tick by tick %.2f us, segments %.2f us per %d ticks, at() %.1f ns, first_entry() %.1f ns, scan %.1f ns\n"
+            , scenario, tick_ns / 1e3, build_ns / count / 1e3, horizon, at_ns / count, entry_ns / count, scan_ns / count);
+    }
+
+    // A game of consistent ticks: the prediction rebuilt every tick against one only extended by the new tail
+    const vector<Entity> starts = BallStarts(rules, "bouncing", 100);
+    const int game_ticks = 500;
+    for (int ticks : { 100, 300 })
+    {
+        BallTrajectory game_path(sim, ticks);
+        double ns[2] = {};
+        BallTrajectory::Stats stats[2];
+        for (int incremental = 0; incremental < 2; ++incremental)
+        {
+            Stopwatch sw;
+            for (auto& start : starts)
+            {
+                game_path.reset(start, 0);
+                for (int tick = 0; tick < game_ticks; ++tick)
+                {
+                    if (incremental)
+                    {
+                        game_path.forget(tick);
+                    }
+                    else
+                    {
+                        game_path.reset(game_path.at(tick), tick);
+                    }
+                    game_path.grow(tick + ticks - 1);
+                }
+                stats[incremental].predicted += game_path.stats().predicted;
+                stats[incremental].stepped += game_path.stats().stepped;
+                game_path.reset_stats();
+                s_sink = s_sink + game_path.at(game_ticks).pos.y;
+            }
+            ns[incremental] = sw.ns();
+        }
+
+        const double count = (double)starts.size() * game_ticks;
+        printf("trajectory horizon %d: rebuilt %.1f ticks (%.1f stepped) %.2f us, extended %.1f ticks (%.1f stepped) %.2f us per game tick\n"
+            , ticks, stats[0].predicted / count, stats[0].stepped / count, ns[0] / count / 1e3
+            , stats[1].predicted / count, stats[1].stepped / count, ns[1] / count / 1e3);
+    }
+}
+
+// correct() has to return the first tick the old prediction is off by more than rejoin, not a later one
+static bool FirstOffRight(const BallTrajectory& before, const BallTrajectory& after, int tick, int off, real_t rejoin)
+{
+    auto is_off = [&](int t)
+    {
+        const Entity a = before.at(t), b = after.at(t);
+        return !before.predicted(t) || !after.predicted(t) || max(a.pos.dist(b.pos), a.vel.dist(b.vel)) > rejoin;
+    };
+    for (int t = tick + 1; t < off; ++t)
+    {
+        if (is_off(t))
+        {
+            return false;
+        }
+    }
+    return (off == tick) || is_off(off);
+}
+
+// Matches of a ball nudged now and then: small corrections (the server rounds differently)
+// and hits (robots). Every game tick the prediction is corrected and grown to the horizon.
+static void BenchBallCorrections(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    const int horizon = 100;
+    const int game_ticks = 18000;
+    const int look = 50;
+    const real_t match = 0.001_r, rejoin = 0.01_r;
+
+    const vector<Entity> kickoffs = BallStarts(rules, "bouncing", 100);
+    for (real_t tolerance : { match, rejoin })
+    {
+        mt19937 rng(20181222);
+        uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+        uniform_real_distribution<real_t> chance(0.0_r, 1.0_r);
+        BallTrajectory path(sim, horizon), fresh(sim, look + 1);
+        Entity ball = kickoffs[0];
+        size_t kickoff = 0, replans = 0, wrong_off = 0;
+        real_t look_error = 0.0_r;
+        double ns = 0.0;
+        for (int tick = 0; tick < game_ticks; ++tick)
+        {
+            const BallTrajectory before = path;
+            Stopwatch sw;
+            path.forget(tick);
+            const int off = path.correct(ball, tick, match, tolerance);
+            path.grow(tick + horizon - 1);
+            ns += sw.ns();
+            replans += (off >= 0);
+            wrong_off += (off >= 0) && !FirstOffRight(before, path, tick, off, tolerance);
+
+            fresh.reset(ball, tick);
+            fresh.grow(tick + look);
+            look_error = max(look_error, path.at(tick + look).pos.dist(fresh.at(tick + look).pos));
+
+            if (abs(ball.pos.z) >= sim.goal_line())
+            {
+                ball = kickoffs[++kickoff % kickoffs.size()];
+                continue;
+            }
+            ball = sim.tick_alone(ball);
+            const real_t roll = chance(rng);
+            if (roll < 0.005_r)
+            {
+                ball.vel += vec3(unit(rng), unit(rng), unit(rng)) * 10.0_r;
+            }
+            else if (roll < 0.1_r)
+            {
+                ball.vel += vec3(unit(rng), unit(rng), unit(rng)) * 0.003_r;
+            }
+        }
+        path.reset_stats();
+
+        const BallTrajectory::Stats& totals = path.totals();
+        const double count = (double)game_ticks;
+        printf("correct rejoin %.3f: %.2f ticks (%.2f stepped) %.2f us per game tick, %.2f reused, %d anchored, %d missed, %d resets, %zu replans (%zu from a wrong tick%s), error at +%d %.2e\n"
+            , tolerance, totals.predicted / count, totals.stepped / count, ns / count / 1e3
+            , totals.reused / count, totals.anchored, totals.missed, totals.resets, replans, wrong_off, wrong_off ? " FAILED" : "", look, look_error);
+    }
+}
+
+// Recorded ball trajectories played again in the precision of this build. A double build records
+// them into s_drift_file (and checks itself against them), a LINAL_FLOAT build run in the same
+// directory starts from the same states and reports how far off its prediction gets per tick.
+static const char* s_drift_file = "ball_drift.bin";
+static const char* s_drift_scenarios[] = { "free flight", "bouncing", "rolling" };
+static const int s_drift_balls = 64;
+static const int s_drift_ticks = 200;
+
+struct DriftState
+{
+    double pos[3];
+    double vel[3];
+};
+
+static DriftState ToDriftState(const Entity& e)
+{
+    return { { e.pos.x, e.pos.y, e.pos.z }, { e.vel.x, e.vel.y, e.vel.z } };
+}
+
+static void BenchBallDrift(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    const size_t scenarios = sizeof(s_drift_scenarios) / sizeof(s_drift_scenarios[0]);
+    const size_t states = scenarios * s_drift_balls * s_drift_ticks;
+    vector<Entity> ticks(s_drift_ticks);
+    vector<DriftState> recorded(states);
+
+#ifndef LINAL_FLOAT
+    for (size_t i = 0; i < scenarios; ++i)
+    {
+        const vector<Entity> starts = BallStarts(rules, s_drift_scenarios[i], s_drift_balls);
+        for (int j = 0; j < s_drift_balls; ++j)
+        {
+            TickByTick(sim, starts[j], ticks);
+            for (int k = 0; k < s_drift_ticks; ++k)
+            {
+                recorded[(i * s_drift_balls + j) * s_drift_ticks + k] = ToDriftState(ticks[k]);
+            }
+        }
+    }
+    FILE* out = fopen(s_drift_file, "wb");
+    if (!out || fwrite(recorded.data(), sizeof(DriftState), states, out) != states)
+    {
+        printf("drift: cannot write %s\n", s_drift_file);
+    }
+    if (out)
+    {
+        fclose(out);
+    }
+#endif
+
+    FILE* in = fopen(s_drift_file, "rb");
+    const bool read = in && (fread(recorded.data(), sizeof(DriftState), states, in) == states);
+    if (in)
+    {
+        fclose(in);
+    }
+    if (!read)
+    {
+        printf("drift: no %s, record it with a double build first\n", s_drift_file);
+        return;
+    }
+
+    const Entity ball = BallStarts(rules, "free flight", 1)[0];
+    const int marks[] = { 1, 2, 5, 10, 20, 50, 100, 150, 199 };
+    const double limits[] = { 0.001, 0.01, 0.1 };
+    printf("drift of %s: ball position off the double recording, max (mean) per tick\n", (sizeof(real_t) == sizeof(double)) ? "double" : "float");
+    for (size_t i = 0; i < scenarios; ++i)
+    {
+        vector<double> worst(s_drift_ticks), sum(s_drift_ticks);
+        for (int j = 0; j < s_drift_balls; ++j)
+        {
+            const DriftState* track = &recorded[(i * s_drift_balls + j) * s_drift_ticks];
+            Entity start = ball;
+            start.pos = vec3((real_t)track[0].pos[0], (real_t)track[0].pos[1], (real_t)track[0].pos[2]);
+            start.vel = vec3((real_t)track[0].vel[0], (real_t)track[0].vel[1], (real_t)track[0].vel[2]);
+            TickByTick(sim, start, ticks);
+            for (int k = 0; k < s_drift_ticks; ++k)
+            {
+                const DriftState now = ToDriftState(ticks[k]);
+                double sq = 0.0;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    sq += (now.pos[axis] - track[k].pos[axis]) * (now.pos[axis] - track[k].pos[axis]);
+                }
+                worst[k] = max(worst[k], sqrt(sq));
+                sum[k] += sqrt(sq);
+            }
+        }
+
+        printf("drift %s:", s_drift_scenarios[i]);
+        for (int mark : marks)
+        {
+            printf(" +%d %.1e (%.1e)", mark, worst[mark], sum[mark] / s_drift_balls);
+        }
+        printf("\ndrift %s: stays within", s_drift_scenarios[i]);
+        for (double limit : limits)
+        {
+            int safe = 0;
+            while (safe < s_drift_ticks && worst[safe] <= limit)
+            {
+                ++safe;
+            }
+            printf(" %g up to +%d%s", limit, safe - 1, (safe == s_drift_ticks) ? " (all)" : "");
+        }
+        printf("\n");
+    }
+}
+
+// Server stream of a match for the replay benchmark: the rules line, then one line per game tick.
+// Taken from s_replay_file when there is one (a capture of what the server sent), made up
+// by the simulator with random actions otherwise.
+static const char* s_replay_file = "match.jsonl";
+
+static string MatchStream(const Rules& rules, int ticks, const char* file = s_replay_file)
+{
+    string stream;
+    FILE* in = fopen(file, "rb");
+    if (in)
+    {
+        char chunk[8 * 1024];
+        for (size_t size; (size = fread(chunk, 1, sizeof(chunk), in)) > 0; )
+        {
+            stream.append(chunk, size);
+        }
+        fclose(in);
+        return stream;
+    }
+
+    rapidjson::Document d;
+    d.Parse(s_default_rules);
+    rapidjson::StringBuffer line;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(line);
+    d.Accept(writer);
+    stream.append(line.GetString()).push_back('\n');
+
+    mt19937 rng(20181223);
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    World world = BenchWorld(rules, rng);
+    char text[1024];
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        snprintf(text, sizeof(text), "{\"current_tick\":%d,\"players\":[{\"id\":1,\"me\":true,\"strategy_crashed\":false,\"score\":0},"
+            "{\"id\":2,\"me\":false,\"strategy_crashed\":false,\"score\":0}],\"robots\":[", tick);
+        stream.append(text);
+        for (int i = 0; i < world.bot_count; ++i)
+        {
+            const Entity& bot = world.bots[i];
+            const int id = world.ids[i];
+            const int player = (i < world.teammates) ? 1 : 2;
+            snprintf(text, sizeof(text), "%s{\"id\":%d,\"player_id\":%d,\"is_teammate\":%s,\"x\":%.17g,\"y\":%.17g,\"z\":%.17g,"
+                "\"velocity_x\":%.17g,\"velocity_y\":%.17g,\"velocity_z\":%.17g,\"radius\":%.17g,\"nitro_amount\":%.17g,\"touch\":%s",
+                (i > 0) ? "," : "", id, player, (1 == player) ? "true" : "false",
+                (double)bot.pos.x, (double)bot.pos.y, (double)bot.pos.z, (double)bot.vel.x, (double)bot.vel.y, (double)bot.vel.z,
+                (double)bot.radius, (double)bot.nitro, bot.touch ? "true" : "false");
+            stream.append(text);
+            // The server sends null normals for a robot touching nothing
+            if (bot.touch)
+            {
+                snprintf(text, sizeof(text), ",\"touch_normal_x\":%.17g,\"touch_normal_y\":%.17g,\"touch_normal_z\":%.17g",
+                    (double)bot.normal.x, (double)bot.normal.y, (double)bot.normal.z);
+                stream.append(text);
+            }
+            else
+            {
+                stream.append(",\"touch_normal_x\":null,\"touch_normal_y\":null,\"touch_normal_z\":null");
+            }
+            stream.push_back('}');
+        }
+        stream.append("],\"nitro_packs\":[");
+        for (int i = 0; i < 4; ++i)
+        {
+            snprintf(text, sizeof(text), "%s{\"id\":%d,\"x\":%d.0,\"y\":1.0,\"z\":%d.0,\"radius\":0.5,\"respawn_ticks\":%s}",
+                i ? "," : "", 5 + i, (i & 1) ? 20 : -20, (i & 2) ? 20 : -20, (tick % 300 < 100) ? "null" : "42");
+            stream.append(text);
+        }
+        snprintf(text, sizeof(text), "],\"ball\":{\"x\":%.17g,\"y\":%.17g,\"z\":%.17g,\"velocity_x\":%.17g,\"velocity_y\":%.17g,\"velocity_z\":%.17g,\"radius\":%.17g}}\n",
+            (double)world.ball.pos.x, (double)world.ball.pos.y, (double)world.ball.pos.z,
+            (double)world.ball.vel.x, (double)world.ball.vel.y, (double)world.ball.vel.z, (double)world.ball.radius);
+        stream.append(text);
+
+        BenchActions(rules, world, rng);
+        sim.tick(world);
+        if (world.goal)
+        {
+            world = BenchWorld(rules, rng);
+        }
+    }
+    return stream;
+}
+
+string MatchStream(const char* file, int ticks)
+{
+    rapidjson::Document d;
+    d.Parse(s_default_rules);
+    Rules rules;
+    rules.read(d);
+    return MatchStream(rules, ticks, file ? file : s_replay_file);
+}
+
+// The old RemoteProcessClient::readline(): every line cut off a string, the rest copied over
+static string LegacyReadline(const string& stream, size_t& fed, string& buffer)
+{
+    while (true)
+    {
+        const size_t eol = buffer.find('\n');
+        if (eol != string::npos)
+        {
+            string line = buffer.substr(0, eol);
+            buffer = buffer.substr(eol + 1);
+            return line;
+        }
+        const size_t received = min((size_t)8 * 1024, stream.size() - fed);
+        if (0 == received)
+        {
+            return "";
+        }
+        buffer.append(stream.data() + fed, stream.data() + fed + received);
+        fed += received;
+    }
+}
+
+static string_view BufferedReadline(const string& stream, size_t& fed, LineBuffer& buffer)
+{
+    while (true)
+    {
+        const string_view line = buffer.next_line();
+        if (line.data())
+        {
+            return line;
+        }
+        const size_t received = min((size_t)8 * 1024, stream.size() - fed);
+        if (0 == received)
+        {
+            return string_view();
+        }
+        memcpy(buffer.reserve(received), stream.data() + fed, received);
+        buffer.commit(received);
+        fed += received;
+    }
+}
+
+// Stream to model::Game the way RemoteProcessClient reads it, the socket delivers 8 KB at most at a time
+static void BenchReplay(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+
+    // Framing alone, lines cut and nothing parsed
+    double framing[2] = {};
+    for (int way = 0; way < 2; ++way)
+    {
+        size_t fed = 0, lines = 0;
+        string text;
+        LineBuffer buffer;
+        Stopwatch sw;
+        while (way ? !BufferedReadline(stream, fed, buffer).empty() : !LegacyReadline(stream, fed, text).empty())
+        {
+            ++lines;
+        }
+        framing[way] = sw.ns() / max(lines, (size_t)1);
+    }
+    printf("replay framing: string lines %.0f ns per line, line buffer %.0f ns per line\n", framing[0], framing[1]);
+
+    for (int way = 0; way < 2; ++way)
+    {
+        size_t fed = 0;
+        string text;
+        LineBuffer buffer;
+        double checksum = 0.0, worst = 0.0;
+        int ticks = 0;
+        Stopwatch total;
+        for (bool first = true; ; first = false)
+        {
+            Stopwatch sw;
+            rapidjson::Document d;
+            if (0 == way)
+            {
+                const string line = LegacyReadline(stream, fed, text);
+                if (line.empty())
+                {
+                    break;
+                }
+                d.Parse(line.c_str());
+            }
+            else
+            {
+                const string_view line = BufferedReadline(stream, fed, buffer);
+                if (line.empty())
+                {
+                    break;
+                }
+                d.ParseInsitu(buffer.data(line));
+            }
+            if (first)
+            {
+                Rules read;
+                read.read(d);
+                continue;
+            }
+            unique_ptr<Game> game(new Game());
+            game->read(d);
+            worst = max(worst, sw.ns());
+            checksum += game->ball.x + game->robots.back().velocity_z;
+            ++ticks;
+        }
+        const double ns = total.ns();
+
+        printf("replay %s: %d ticks, %.0f bytes per tick, %.2f us per tick (worst %.1f us), checksum %.6f\n"
+            , way ? "line buffer, in place" : "string lines", ticks, (double)stream.size() / max(ticks, 1)
+            , ns / max(ticks, 1) / 1e3, worst / 1e3, checksum);
+    }
+}
+
+static bool SameGame(const Game& a, const Game& b)
+{
+    bool same = (a.current_tick == b.current_tick) && (a.players.size() == b.players.size())
+        && (a.robots.size() == b.robots.size()) && (a.nitro_packs.size() == b.nitro_packs.size())
+        && (0 == memcmp(&a.ball, &b.ball, sizeof(Ball)));
+    for (size_t i = 0; same && i < a.players.size(); ++i)
+    {
+        const Player& p = a.players[i];
+        const Player& q = b.players[i];
+        same = (p.id == q.id) && (p.me == q.me) && (p.strategy_crashed == q.strategy_crashed) && (p.score == q.score);
+    }
+    for (size_t i = 0; same && i < a.robots.size(); ++i)
+    {
+        const Robot& r = a.robots[i];
+        const Robot& q = b.robots[i];
+        same = (r.id == q.id) && (r.player_id == q.player_id) && (r.is_teammate == q.is_teammate)
+            && (r.x == q.x) && (r.y == q.y) && (r.z == q.z)
+            && (r.velocity_x == q.velocity_x) && (r.velocity_y == q.velocity_y) && (r.velocity_z == q.velocity_z)
+            && (r.radius == q.radius) && (r.nitro_amount == q.nitro_amount) && (r.touch == q.touch)
+            && (!r.touch || ((r.touch_normal_x == q.touch_normal_x) && (r.touch_normal_y == q.touch_normal_y) && (r.touch_normal_z == q.touch_normal_z)));
+    }
+    for (size_t i = 0; same && i < a.nitro_packs.size(); ++i)
+    {
+        const NitroPack& n = a.nitro_packs[i];
+        const NitroPack& q = b.nitro_packs[i];
+        same = (n.id == q.id) && (n.x == q.x) && (n.y == q.y) && (n.z == q.z) && (n.radius == q.radius)
+            && (n.alive == q.alive) && (n.alive || (n.respawn_ticks == q.respawn_ticks));
+    }
+    return same;
+}
+
+// Tick lines of a match into model::Game, from the DOM and by JsonDecoder.
+// Both parse a copy of the line in place, the DOM path makes a new Game every tick as it did.
+static void BenchDecoder(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+    vector<string> lines;
+    for (size_t begin = 0, end; (end = stream.find('\n', begin)) != string::npos; begin = end + 1)
+    {
+        lines.push_back(stream.substr(begin, end - begin));
+    }
+    vector<char> scratch;
+    auto copy = [&scratch](const string& line)
+    {
+        scratch.assign(line.c_str(), line.c_str() + line.size() + 1);
+        return scratch.data();
+    };
+
+    Rules dom_rules, decoded_rules;
+    rapidjson::Document d;
+    d.ParseInsitu(copy(lines[0]));
+    dom_rules.read(d);
+    const bool rules_read = JsonDecoder::read(copy(lines[0]), decoded_rules);
+    const bool rules_same = rules_read && (0 == memcmp(&dom_rules.arena, &decoded_rules.arena, sizeof(Arena)))
+        && (dom_rules.seed == decoded_rules.seed) && (dom_rules.NITRO_PACK_RESPAWN_TICKS == decoded_rules.NITRO_PACK_RESPAWN_TICKS)
+        && (dom_rules.GRAVITY == decoded_rules.GRAVITY) && (dom_rules.MAX_HIT_E == decoded_rules.MAX_HIT_E);
+
+    Game decoded;
+    size_t mismatches = 0, failures = 0, in_air = 0, normals = 0;
+    for (size_t i = 1; i < lines.size(); ++i)
+    {
+        rapidjson::Document tick;
+        tick.ParseInsitu(copy(lines[i]));
+        Game dom;
+        dom.read(tick);
+        failures += !JsonDecoder::read(copy(lines[i]), decoded);
+        mismatches += !SameGame(dom, decoded);
+        for (const Robot& robot : decoded.robots)
+        {
+            in_air += robot.touch ? 0 : 1;
+            normals += (!robot.touch && ((0.0 != robot.touch_normal_x) || (0.0 != robot.touch_normal_y) || (0.0 != robot.touch_normal_z))) ? 1 : 0;
+        }
+    }
+    printf("decode: %zu ticks, rules %s, %zu failed, %zu differ from the DOM; %zu robots in the air (null normals), %zu of them with a normal%s\n"
+        , lines.size() - 1, rules_same ? "same" : "DIFFER", failures, mismatches, in_air, normals
+        , (0 == in_air || normals) ? " FAILED" : "");
+
+    double ns[2] = {};
+    double checksum[2] = {};
+    for (int round = 0; round < 5; ++round)
+    {
+        for (int way = 0; way < 2; ++way)
+        {
+            Stopwatch sw;
+            for (size_t i = 1; i < lines.size(); ++i)
+            {
+                char* line = copy(lines[i]);
+                if (0 == way)
+                {
+                    rapidjson::Document tick;
+                    tick.ParseInsitu(line);
+                    unique_ptr<Game> game(new Game());
+                    game->read(tick);
+                    checksum[way] += game->ball.x;
+                }
+                else
+                {
+                    JsonDecoder::read(line, decoded);
+                    checksum[way] += decoded.ball.x;
+                }
+            }
+            ns[way] += sw.ns();
+        }
+    }
+
+    const double count = 5.0 * (lines.size() - 1);
+    printf("decode: DOM %.2f us per tick, JsonDecoder %.2f us per tick, x%.1f, checksums %s\n"
+        , ns[0] / count / 1e3, ns[1] / count / 1e3, ns[0] / ns[1], (checksum[0] == checksum[1]) ? "same" : "DIFFER");
+}
+
+// A match replayed through the client code without the socket: lines framed, decoded into the
+// Game, an action for every teammate encoded. Once the first tick has sized everything,
+// a tick must not allocate. The old client (string lines, a DOM per line, a Document
+// per answer) is counted for comparison.
+static void BenchAllocations(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+    unordered_map<int, Action> actions;
+
+    size_t fed = 0;
+    LineBuffer buffer;
+    ActionEncoder encoder;
+    Rules read_rules;
+    Game game;
+    size_t before = 0, bytes = 0;
+    int ticks = 0;
+    for (string_view line; !(line = BufferedReadline(stream, fed, buffer)).empty(); )
+    {
+        if (0 == ticks++)
+        {
+            JsonDecoder::read(buffer.data(line), read_rules);
+            continue;
+        }
+        JsonDecoder::read(buffer.data(line), game);
+        for (const Robot& robot : game.robots)
+        {
+            if (robot.is_teammate)
+            {
+                Action& action = actions[robot.id];
+                action = Action();
+                action.target_velocity_x = robot.velocity_x;
+                action.jump_speed = game.ball.y;
+            }
+        }
+        bytes += encoder.encode(actions, "").size();
+        if (2 == ticks)
+        {
+            before = AllocationCount();
+        }
+    }
+    const size_t steady = AllocationCount() - before;
+
+    fed = 0;
+    string text;
+    before = AllocationCount();
+    LegacyReadline(stream, fed, text);
+    for (string line; !(line = LegacyReadline(stream, fed, text)).empty(); )
+    {
+        rapidjson::Document d;
+        d.Parse(line.c_str());
+        unique_ptr<Game> old_game(new Game());
+        old_game->read(d);
+        actions.clear();
+        for (const Robot& robot : old_game->robots)
+        {
+            if (robot.is_teammate)
+            {
+                actions[robot.id].jump_speed = old_game->ball.y;
+            }
+        }
+        rapidjson::Document answer;
+        answer.SetObject();
+        for (auto it : actions)
+        {
+            answer.AddMember(rapidjson::Value(to_string(it.first).c_str(), answer.GetAllocator()).Move(), it.second.to_json(answer.GetAllocator()).Move(), answer.GetAllocator());
+        }
+        rapidjson::StringBuffer json;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(json);
+        answer.Accept(writer);
+        bytes += (string(json.GetString()) + "|" + "" + "\n<end>").size();
+    }
+    const size_t legacy = AllocationCount() - before;
+
+    printf("alloc: %d ticks, %zu allocations after the first tick%s, old client %.1f allocations per tick (%zu bytes sent)\n"
+        , ticks - 1, steady, steady ? " FAILED, expected none" : "", (double)legacy / max(ticks - 1, 1), bytes);
+
+    // The strategy itself past init(), planning and answering every tick
+    unique_ptr<MyStrategy> strategy(new MyStrategy);
+    fed = 0;
+    ticks = 0;
+    int replans = 0;
+    for (string_view line; !(line = BufferedReadline(stream, fed, buffer)).empty(); )
+    {
+        if (0 == ticks++)
+        {
+            continue;
+        }
+        JsonDecoder::read(buffer.data(line), game);
+        const unsigned version = strategy->plan_version();
+        strategy->act_team(read_rules, game, actions);
+        replans += (strategy->plan_version() != version) ? 1 : 0;
+        if (2 == ticks)
+        {
+            before = AllocationCount();
+        }
+    }
+    const size_t planning = AllocationCount() - before;
+    printf("alloc: strategy %.2f allocations per tick after the first tick, %d of %d ticks replanned\n"
+        , (double)planning / max(ticks - 2, 1), replans, ticks - 1);
+
+    // Both teammates in the air with the ball falling as predicted: the flights go on, the plans stay
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    mt19937 rng(20181227);
+    World world = BenchWorld(rules, rng);
+    world.ball.pos = vec3(0.0_r, 15.0_r, 20.0_r);
+    world.ball.vel = vec3();
+    for (int i = 0; i < world.teammates; ++i)
+    {
+        world.bots[i].pos.y = 5.0_r;
+        world.bots[i].vel = vec3(0.0_r, 5.0_r, 0.0_r);
+        world.bots[i].touch = false;
+    }
+    strategy.reset(new MyStrategy);
+    unsigned versions[3] = {};
+    for (int tick = 0; tick < 3; ++tick)
+    {
+        WorldGame(world, tick, game);
+        strategy->act_team(read_rules, game, actions);
+        versions[tick] = strategy->plan_version();
+        WorldActions(actions, world);
+        sim.tick(world);
+    }
+    const bool kept = (versions[1] == versions[0]) && (versions[2] == versions[0]);
+    printf("alloc: bots in the air, plan version %u on the first tick, then %u and %u%s\n"
+        , versions[0], versions[1], versions[2], kept ? "" : " FAILED, expected it kept");
+}
+
+// The old RemoteProcessClient::write(): a Document, the line put together from strings,
+// and writeline() copying it once more for the '\n'
+static string LegacyWrite(const unordered_map<int, Action>& actions, const string& custom_rendering)
+{
+    rapidjson::Document d;
+    d.SetObject();
+    rapidjson::Document::AllocatorType& allocator = d.GetAllocator();
+    for (auto it : actions)
+    {
+        d.AddMember(rapidjson::Value(to_string(it.first).c_str(), allocator).Move(), it.second.to_json(allocator).Move(), allocator);
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    d.Accept(writer);
+    string line = string(buffer.GetString()) + "|" + custom_rendering + "\n<end>";
+    line.push_back('\n');
+    return line;
+}
+
+// Answers of a tick (actions of the teammates and the custom rendering) turned into the line to send
+static void BenchWrite(const Rules& rules)
+{
+    mt19937 rng(20181224);
+    uniform_real_distribution<double> v(-30.0, 30.0);
+    const int ticks = 20000;
+    vector<unordered_map<int, Action>> answers(64);
+    for (auto& actions : answers)
+    {
+        for (int id = 1; id <= rules.team_size; ++id)
+        {
+            Action& action = actions[id];
+            action.target_velocity_x = v(rng);
+            action.target_velocity_y = v(rng);
+            action.target_velocity_z = v(rng);
+            action.jump_speed = (id & 1) ? 15.0 : 0.0;
+            action.use_nitro = (0 == (id & 2));
+        }
+    }
+
+    // A debug rendering of a few spheres and lines
+    string rendering = "[";
+    while (rendering.size() < 2000)
+    {
+        rendering += R"({"Sphere":{"x":1.25,"y":2.5,"z":-13.75,"radius":1.0,"r":1.0,"g":0.0,"b":0.0,"a":0.5}},)";
+    }
+    rendering.back() = ']';
+
+    ActionEncoder encoder;
+    for (const string& payload : { string(), rendering })
+    {
+        bool same = true;
+        for (const auto& actions : answers)
+        {
+            same = same && (LegacyWrite(actions, payload) == encoder.encode(actions, payload));
+        }
+
+        double ns[2] = {};
+        size_t bytes = 0;
+        for (int way = 0; way < 2; ++way)
+        {
+            Stopwatch sw;
+            for (int tick = 0; tick < ticks; ++tick)
+            {
+                const auto& actions = answers[tick % answers.size()];
+                bytes += way ? encoder.encode(actions, payload).size() : LegacyWrite(actions, payload).size();
+            }
+            ns[way] = sw.ns();
+        }
+
+        const double per_tick = (double)bytes / 2 / ticks;
+        printf("write, %zu bytes of rendering: %.0f bytes per tick, Document %.0f ns per tick %.0f MB/s, encoder %.0f ns per tick %.0f MB/s, x%.1f, %s text\n"
+            , payload.size(), per_tick, ns[0] / ticks, per_tick * ticks * 1e3 / ns[0], ns[1] / ticks, per_tick * ticks * 1e3 / ns[1]
+            , ns[0] / ns[1], same ? "same" : "DIFFERENT");
+    }
+}
+
+// Loopback check of the socket receive calls against CPassiveSocket: a match stream sent in
+// chunks of random sizes, received through Receive() and a copy out of GetData(), through
+// ReceiveInto() right into a LineBuffer, and through the iovec Receive() into the two halves
+// of a buffer. All must give back the stream as it was sent.
+static void BenchSocket(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+    const int port = 31097;
+    CPassiveSocket listener;
+    if (!listener.Initialize() || !listener.Listen(reinterpret_cast<const uint8*>("127.0.0.1"), (int16)port))
+    {
+        printf("socket: port %d is busy\n", port);
+        return;
+    }
+
+    const char* way_names[] = { "Receive + copy", "ReceiveInto", "Receive iovec" };
+    for (int way = 0; way < 3; ++way)
+    {
+        thread sending([&]()
+        {
+            unique_ptr<CActiveSocket> peer(listener.Accept());
+            mt19937 rng(20181225);
+            uniform_int_distribution<size_t> chunk(1, 3000);
+            for (size_t sent = 0; peer && sent < stream.size(); )
+            {
+                const size_t size = min(chunk(rng), stream.size() - sent);
+                peer->Send(reinterpret_cast<const uint8*>(stream.data() + sent), size);
+                sent += size;
+            }
+        });
+
+        CActiveSocket socket;
+        socket.Initialize();
+        socket.Open(reinterpret_cast<const uint8*>("127.0.0.1"), (int16)port);
+
+        const int32 size = 8 * 1024;
+        LineBuffer buffer(256 * 1024);
+        string received;
+        vector<uint8> halves(2 * size);
+        // Counted from the second receive on, the sending thread has accepted by then
+        size_t calls = 0, allocations = 0;
+        Stopwatch sw;
+        while (true)
+        {
+            const size_t before = AllocationCount();
+            int32 got = 0;
+            if (0 == way)
+            {
+                got = socket.Receive(size);
+                allocations += calls ? AllocationCount() - before : 0;
+                if (got > 0)
+                {
+                    memcpy(buffer.reserve(got), socket.GetData(), got);
+                }
+            }
+            else if (1 == way)
+            {
+                got = socket.ReceiveInto(reinterpret_cast<uint8*>(buffer.reserve(size)), size);
+                allocations += calls ? AllocationCount() - before : 0;
+            }
+            else
+            {
+                const struct iovec parts[2] = { { halves.data(), (size_t)size / 2 }, { halves.data() + size / 2, (size_t)size / 2 } };
+                got = socket.Receive(parts, 2);
+                allocations += calls ? AllocationCount() - before : 0;
+            }
+            if (got <= 0)
+            {
+                break;
+            }
+            if (2 == way)
+            {
+                received.append(reinterpret_cast<const char*>(halves.data()), got);
+            }
+            else
+            {
+                buffer.commit(got);
+                for (string_view line; (line = buffer.next_line()).data(); )
+                {
+                    received.append(line.data(), line.size()).push_back('\n');
+                }
+            }
+            ++calls;
+        }
+        const double ns = sw.ns();
+        sending.join();
+
+        printf("socket, %s: %zu bytes in %zu receives, %.2f ms, %zu allocations in the receives after the first, %s\n"
+            , way_names[way], received.size(), calls, ns / 1e6, allocations, (received == stream) ? "same bytes" : "DIFFERENT bytes");
+    }
+}
+
+// Teammates answered the same way by both protocols in the wire benchmark
+static void WireActions(const Game& game, unordered_map<int, Action>& actions)
+{
+    for (const Robot& robot : game.robots)
+    {
+        if (robot.is_teammate)
+        {
+            Action& action = actions[robot.id];
+            action = Action();
+            action.target_velocity_x = game.ball.x - robot.x;
+            action.target_velocity_z = game.ball.z - robot.z;
+            action.jump_speed = (game.ball.y > 3.0) ? 15.0 : 0.0;
+        }
+    }
+}
+
+// JSON lines against binary frames (BinaryProtocol.h). First the client side alone:
+// a tick decoded and its answer encoded, with the conversion checked to lose nothing.
+// Then a match played over a loopback socket with the stand-in server.
+static void BenchWire(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+    vector<string> lines;
+    for (size_t begin = 0, eol; (eol = stream.find('\n', begin)) != string::npos; begin = eol + 1)
+    {
+        lines.push_back(stream.substr(begin, eol - begin));
+    }
+
+    // Frames of the same ticks, read back into the same Game
+    vector<vector<char>> frames(lines.size());
+    bool same = true;
+    Game json_game, binary_game;
+    for (size_t i = 1; i < lines.size(); ++i)
+    {
+        string text = lines[i];
+        JsonDecoder::read(&text[0], json_game);
+        BinaryProtocol::write(json_game, frames[i]);
+        same = same && BinaryProtocol::read(string_view(frames[i].data() + BinaryProtocol::header_size, frames[i].size() - BinaryProtocol::header_size), binary_game)
+            && SameGame(json_game, binary_game);
+    }
+
+    unordered_map<int, Action> actions, read_actions;
+    string read_rendering;
+    vector<char> frame;
+    WireActions(json_game, actions);
+    BinaryProtocol::write(actions, "", frame);
+    same = same && BinaryProtocol::read(string_view(frame.data() + BinaryProtocol::header_size, frame.size() - BinaryProtocol::header_size), read_actions, read_rendering);
+    for (const auto& item : actions)
+    {
+        const Action& a = item.second;
+        const Action& b = read_actions[item.first];
+        same = same && (a.target_velocity_x == b.target_velocity_x) && (a.target_velocity_y == b.target_velocity_y)
+            && (a.target_velocity_z == b.target_velocity_z) && (a.jump_speed == b.jump_speed) && (a.use_nitro == b.use_nitro);
+    }
+
+    const int rounds = 5;
+    double ns[2] = {};
+    size_t bytes[2] = {};
+    ActionEncoder encoder;
+    string text;
+    for (int way = 0; way < 2; ++way)
+    {
+        Game& game = way ? binary_game : json_game;
+        Stopwatch sw;
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (size_t i = 1; i < lines.size(); ++i)
+            {
+                if (way)
+                {
+                    BinaryProtocol::read(string_view(frames[i].data() + BinaryProtocol::header_size, frames[i].size() - BinaryProtocol::header_size), game);
+                    WireActions(game, actions);
+                    frame.clear();
+                    BinaryProtocol::write(actions, "", frame);
+                    bytes[way] += frames[i].size() + frame.size();
+                }
+                else
+                {
+                    text = lines[i];
+                    JsonDecoder::read(&text[0], game);
+                    WireActions(game, actions);
+                    bytes[way] += lines[i].size() + 1 + encoder.encode(actions, "").size();
+                }
+            }
+        }
+        ns[way] = sw.ns();
+    }
+    const double count = (double)rounds * (lines.size() - 1);
+    printf("wire, client side: json %.2f us %.0f bytes per tick, binary %.2f us %.0f bytes per tick, x%.1f, %s\n"
+        , ns[0] / count / 1e3, bytes[0] / count, ns[1] / count / 1e3, bytes[1] / count, ns[0] / ns[1], same ? "same" : "DIFFERENT");
+
+    // A match over the loopback, the server on a thread of its own
+    const int port = 31099;
+    for (bool binary : { false, true })
+    {
+        StandInServer server;
+        if (!server.listen(port))
+        {
+            printf("wire: port %d is busy, no match played\n", port);
+            return;
+        }
+        StandInServer::Report report;
+        bool served = false;
+        thread serving([&]() { served = server.serve(stream, report); });
+
+        RemoteProcessClient client("127.0.0.1", port, binary);
+        client.write_token("0000000000000000");
+        unique_ptr<Rules> match_rules = client.read_rules();
+        Game game;
+        actions.clear();
+        while (client.read_game(game))
+        {
+            WireActions(game, actions);
+            client.write(actions, "");
+        }
+        serving.join();
+
+        const int ticks = max(report.ticks, 1);
+        printf("wire, loopback %s: %d ticks%s, round trip %.1f us per tick, %.0f bytes sent and %.0f received per tick\n"
+            , binary ? "binary" : "json", report.ticks, served ? "" : " FAILED", report.round_trip_ns / ticks / 1e3
+            , (double)report.bytes_sent / ticks, (double)report.bytes_received / ticks);
+    }
+}
+
+// The match played by the Runner itself, with MyStrategy, against the stand-in server,
+// per tick time of every phase
+static void BenchRunner(const Rules& rules)
+{
+    const string stream = MatchStream(rules, 5000);
+    const int port = 31096;
+    for (bool binary : { false, true })
+    {
+        StandInServer server;
+        if (!server.listen(port))
+        {
+            printf("runner: port %d is busy\n", port);
+            return;
+        }
+        StandInServer::Report report;
+        bool served = false;
+        thread serving([&]() { served = server.serve(stream, report); });
+
+        Runner runner("127.0.0.1", to_string(port).c_str(), "0000000000000000", binary);
+        runner.run();
+        serving.join();
+
+        const Runner::Times& times = runner.get_times();
+        const double ticks = max(times.ticks, 1) * 1e3;
+        printf("runner, %s: %d ticks (%d replanned)%s, us per tick: io %.1f parse %.1f think %.1f serialize %.1f, wall %.1f, server round trip %.1f\n"
+            , binary ? "binary" : "json", times.ticks, times.replans, served ? "" : " FAILED"
+            , times.client.io / ticks, times.client.parse / ticks, times.think / ticks, times.client.serialize / ticks
+            , times.wall / ticks, report.round_trip_ns / ticks);
+    }
+}
+
+// Scaling of the ThreadPool from one thread up: a job of three ball predictions (a bot each, as
+// in the finals format), then the whole MyStrategy planning the three bots on the pool. Every
+// thread count must come to the same results as one thread does.
+static void BenchThreadPool(const Rules& rules)
+{
+    const int max_threads = max(4, (int)thread::hardware_concurrency());
+    printf("pool: %u hardware threads\n", thread::hardware_concurrency());
+
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    const vector<Entity> starts = BallStarts(rules, "bouncing", 3);
+    vector<Entity> first(starts.size());
+    double one_thread = 0.0;
+    for (int threads = 1; threads <= max_threads; ++threads)
+    {
+        ThreadPool pool(threads);
+        vector<Entity> ends(starts.size());
+        auto predict = [&](int i)
+        {
+            Entity e = starts[i];
+            for (int tick = 0; tick < 300; ++tick)
+            {
+                e = sim.tick_alone(e);
+            }
+            ends[i] = e;
+        };
+        const int jobs = 200;
+        Stopwatch sw;
+        for (int job = 0; job < jobs; ++job)
+        {
+            pool.run((int)starts.size(), predict);
+        }
+        const double ns = sw.ns();
+        if (1 == threads)
+        {
+            first = ends;
+            one_thread = ns;
+        }
+        bool same = true;
+        for (size_t i = 0; i < ends.size(); ++i)
+        {
+            same = same && (0 == memcmp(&ends[i].pos, &first[i].pos, sizeof(vec3))) && (0 == memcmp(&ends[i].vel, &first[i].vel, sizeof(vec3)));
+        }
+        printf("pool, 3 ball predictions: %d threads %.1f us per job, x%.2f, %s\n", threads, ns / jobs / 1e3, one_thread / ns, same ? "same" : "DIFFERENT");
+    }
+
+    Rules finals = rules;
+    finals.team_size = 3;
+    const string stream = MatchStream(finals, 2000);
+    vector<string> lines;
+    for (size_t begin = 0, eol; (eol = stream.find('\n', begin)) != string::npos; begin = eol + 1)
+    {
+        lines.push_back(stream.substr(begin, eol - begin));
+    }
+    vector<double> first_actions;
+    one_thread = 0.0;
+    for (int threads = 1; threads <= max_threads; ++threads)
+    {
+        MyStrategy::set_threads(threads);
+        unique_ptr<MyStrategy> strategy(new MyStrategy);
+        Game game;
+        unordered_map<int, Action> actions;
+        vector<double> answers;
+        string text;
+        double ns = 0.0;
+        for (size_t i = 1; i < lines.size(); ++i)
+        {
+            text = lines[i];
+            JsonDecoder::read(&text[0], game);
+            Stopwatch sw;
+            strategy->act_team(finals, game, actions);
+            ns += sw.ns();
+            for (const Robot& robot : game.robots)
+            {
+                if (robot.is_teammate)
+                {
+                    const Action& action = actions[robot.id];
+                    answers.insert(answers.end(), { action.target_velocity_x, action.target_velocity_y, action.target_velocity_z, action.jump_speed, action.use_nitro ? 1.0 : 0.0 });
+                }
+            }
+        }
+        if (1 == threads)
+        {
+            first_actions = answers;
+            one_thread = ns;
+        }
+        printf("pool, MyStrategy with 3 bots: %d threads %.1f us per tick, x%.2f, %s actions\n"
+            , threads, ns / (lines.size() - 1) / 1e3, one_thread / ns, (answers == first_actions) ? "same" : "DIFFERENT");
+    }
+    MyStrategy::set_threads(1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+// Depth first search over the robot actions, three branches a ply: every child is played from
+// a copy of its parent, or in place with the changes saved in an undo log.
+static const int s_search_branches = 3;
+
+static void SearchActions(const Rules& rules, WorldState& state, int branch)
+{
+    const real_t speed = (real_t)rules.ROBOT_MAX_GROUND_SPEED;
+    for (int i = 0; i < state.world.bot_count; ++i)
+    {
+        Entity& bot = state.world.bots[i];
+        bot.target_vel = vec3((real_t)(branch - 1) * speed, 0.0_r, (0 == (i & 1)) ? speed : -speed);
+        bot.jump_speed = (2 == branch) ? (real_t)rules.ROBOT_MAX_JUMP_SPEED : 0.0_r;
+        bot.use_nitro = false;
+    }
+}
+
+static int SearchCopies(const Rules& rules, Simulator& sim, WorldState& state, int depth)
+{
+    if (0 == depth)
+    {
+        return 0;
+    }
+    int plies = 0;
+    for (int branch = 0; branch < s_search_branches; ++branch)
+    {
+        WorldState child = state;
+        SearchActions(rules, child, branch);
+        child.advance(sim);
+        plies += 1 + SearchCopies(rules, sim, child, depth - 1);
+    }
+    s_sink = s_sink + state.world.ball.pos.y;
+    return plies;
+}
+
+static int SearchUndo(const Rules& rules, Simulator& sim, WorldUndo& undo, WorldState& state, int depth, size_t& max_bytes)
+{
+    if (0 == depth)
+    {
+        return 0;
+    }
+    int plies = 0;
+    for (int branch = 0; branch < s_search_branches; ++branch)
+    {
+        const size_t mark = undo.mark();
+        undo.save_tick(state);
+        SearchActions(rules, state, branch);
+        state.advance(sim);
+        max_bytes = max(max_bytes, undo.bytes());
+        plies += 1 + SearchUndo(rules, sim, undo, state, depth - 1, max_bytes);
+        undo.undo(state, mark);
+    }
+    s_sink = s_sink + state.world.ball.pos.y;
+    return plies;
+}
+
+static void BenchWorldState(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    mt19937 rng(20181224);
+
+    WorldState root;
+    root.world = BenchWorld(rules, rng);
+    root.reset_delay = rules.RESET_TICKS;
+
+    const int clones = 1000000;
+    vector<WorldState> copies(64);
+    Stopwatch sw;
+    for (int i = 0; i < clones; ++i)
+    {
+        copies[i & 63] = root;
+    }
+    const double clone_ns = sw.ns();
+    s_sink = s_sink + copies[clones & 63].world.ball.pos.y;
+    printf("state snapshot: %d bytes, %.1f ns, %.1fM clones/s\n", (int)sizeof(WorldState), clone_ns / clones, clones * 1e3 / clone_ns);
+
+    const int depth = 5;
+    const int searches = 20;
+    int plies = 0;
+    sw = Stopwatch();
+    for (int i = 0; i < searches; ++i)
+    {
+        WorldState state = root;
+        plies = SearchCopies(rules, sim, state, depth);
+    }
+    const double copy_ns = sw.ns();
+
+    WorldUndo undo;
+    size_t max_bytes = 0;
+    WorldState state;
+    memcpy(&state, &root, sizeof(WorldState));
+    sw = Stopwatch();
+    for (int i = 0; i < searches; ++i)
+    {
+        SearchUndo(rules, sim, undo, state, depth, max_bytes);
+    }
+    const double undo_ns = sw.ns();
+    const bool same = (0 == memcmp(&state, &root, sizeof(WorldState)));
+    printf("state search, %d plies %d deep: copies %.2f us a ply, undo log %.2f us a ply, %d bytes a ply, %d bytes deepest, root %s\n"
+        , plies, depth, copy_ns / searches / plies / 1e3, undo_ns / searches / plies / 1e3
+        , (int)(max_bytes / depth), (int)max_bytes, same ? "restored" : "CHANGED");
+}
+
+// Robots on the floor and on the ramps and walls, Simulator::robot_tick() against a world with
+// the robot alone (the ball high over the center, out of its way) and against the flat model
+// the planner had: the target velocity taken as is, nothing but the floor under the robot.
+static void BenchGround(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    mt19937 rng(20181225);
+    uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+    uniform_int_distribution<int> run_ticks(10, 120);
+    const real_t max_speed = (real_t)rules.ROBOT_MAX_GROUND_SPEED;
+
+    World alone = BenchWorld(rules, rng);
+    alone.ball.pos = vec3(0.0_r, 15.0_r, 0.0_r);
+    alone.ball.vel = vec3();
+    alone.bot_count = 1;
+    alone.teammates = 1;
+
+    // Starts: a while towards a random point of the arena edge, most of them end up on a ramp or a wall
+    vector<Entity> floor, walls;
+    while (floor.size() < 500 || walls.size() < 500)
+    {
+        World world = alone;
+        Entity& bot = world.bots[0];
+        bot.pos = vec3(unit(rng) * (real_t)rules.arena.width / 2.5_r, bot.radius, unit(rng) * (real_t)rules.arena.depth / 2.5_r);
+        bot.vel = vec3();
+        bot.target_vel = vec3(unit(rng), unit(rng), unit(rng)).normal() * max_speed;
+        for (int tick = run_ticks(rng); tick > 0; --tick)
+        {
+            sim.tick(world);
+        }
+        bot.target_vel = vec3(unit(rng), unit(rng), unit(rng)).normal() * max_speed;
+        if (bot.touch)
+        {
+            vector<Entity>& starts = (bot.normal.y >= 1.0_r) ? floor : walls;
+            if (starts.size() < 500)
+            {
+                starts.push_back(bot);
+            }
+        }
+    }
+
+    const int ticks = 20;
+    for (const auto* starts : { &floor, &walls })
+    {
+        real_t error = 0.0_r, flat_error = 0.0_r;
+        double world_ns = 0.0, robot_ns = 0.0;
+        for (const Entity& start : *starts)
+        {
+            World world = alone;
+            world.bots[0] = start;
+            Stopwatch world_sw;
+            for (int tick = 0; tick < ticks; ++tick)
+            {
+                sim.tick(world);
+            }
+            world_ns += world_sw.ns();
+
+            Entity bot = start;
+            Stopwatch robot_sw;
+            for (int tick = 0; tick < ticks; ++tick)
+            {
+                sim.robot_tick(bot);
+            }
+            robot_ns += robot_sw.ns();
+
+            vec3 pos = start.pos, vel = start.vel;
+            const vec3 flat_target(start.target_vel.x, 0.0_r, start.target_vel.z);
+            for (int tick = 0; tick < ticks; ++tick)
+            {
+                sim.ground_tick(pos, vel, flat_target);
+            }
+            error = max(error, bot.pos.dist(world.bots[0].pos));
+            flat_error = max(flat_error, pos.dist(world.bots[0].pos));
+        }
+        const double count = (double)starts->size() * ticks;
+        printf("ground %s: robot_tick %.0f ns, world of one robot %.0f ns, max error after %d ticks %.2e, flat model %.2f\n"
+            , (starts == &floor) ? "floor" : "ramps and walls", robot_ns / count, world_ns / count, ticks, error, flat_error);
+    }
+
+    // MyStrategy playing through the simulator against robots standing still. On every jump the
+    // forward plans its flight: the tick of the jump by robot_tick, the rest out of the JumpArc
+    // table. It is held against the simulator up to the tick before the planned hit, or until the
+    // bot runs into the ball or a robot earlier (it then moves off the way it would alone).
+    const int matches = 40, match_ticks = 600;
+    int jumps = 0, flight_ticks = 0, hits = 0;
+    real_t flight_error = 0.0_r;
+    unordered_map<int, Action> actions;
+    Game game;
+    for (int match = 0; match < matches; ++match)
+    {
+        unique_ptr<MyStrategy> strategy(new MyStrategy);
+        World world = BenchWorld(rules, rng);
+        vector<vec3> planned[World::max_bots];
+        int jump_tick[World::max_bots] = {};
+        Entity alone[World::max_bots];
+        for (int tick = 0; tick < match_ticks && !world.goal; ++tick)
+        {
+            WorldGame(world, tick, game);
+            strategy->act_team(rules, game, actions);
+            WorldActions(actions, world);
+            for (int i = 0; i < world.teammates; ++i)
+            {
+                const MyStrategy::MyBot* bot = strategy->find_bot(world.ids[i]);
+                // A jump at the ball right over the bot plans no flight, its target tick is now
+                if (world.bots[i].touch && (world.bots[i].jump_speed > 0.0_r) && bot && (bot->target_tick > tick))
+                {
+                    planned[i].clear();
+                    for (int step = 0; step < bot->actions.size(); ++step)
+                    {
+                        planned[i].push_back(bot->actions[step].pos);
+                    }
+                    jump_tick[i] = tick;
+                    ++jumps;
+                }
+                alone[i] = world.bots[i];
+                sim.robot_tick(alone[i]);
+            }
+            sim.tick(world);
+            for (int i = 0; i < world.teammates; ++i)
+            {
+                // Flight tick k is the bot after k ticks, the last one is the hit
+                const int step = tick - jump_tick[i];
+                if (step + 1 >= (int)planned[i].size())
+                {
+                    continue;
+                }
+                if (alone[i].pos.dist(world.bots[i].pos) > 1e-6_r)
+                {
+                    planned[i].clear();
+                    ++hits;
+                    continue;
+                }
+                flight_error = max(flight_error, planned[i][step].dist(world.bots[i].pos));
+                ++flight_ticks;
+            }
+        }
+    }
+    printf("ground, jumps in %d matches of %d ticks: %d planned flights (%d hit something early), %d ticks compared, max error %.2e%s\n"
+        , matches, match_ticks, jumps, hits, flight_ticks, flight_error, jumps ? "" : " FAILED, no jump reached");
+}
+
+// The forward planner's flight before JumpArc: the arc made again tick by tick, from the bot
+// after the tick of the jump
+static JumpArc::Contact LegacyJumpScan(const Rules& rules, const BallTrajectory& ball, vec3 pos, vec3 vel, real_t reach, real_t max_x, real_t floor_y)
+{
+    const real_t timestep = 1.0_r / (real_t)rules.TICKS_PER_SECOND;
+    const real_t gravity = (real_t)rules.GRAVITY;
+    const real_t jump_speed = (real_t)rules.ROBOT_MAX_JUMP_SPEED;
+    const int air_ticks = (int)floor(jump_speed / gravity / timestep);
+    JumpArc::Contact ret;
+    for (int tick = 1; tick < air_ticks; ++tick)
+    {
+        const vec3 ball_pos = ball.at(tick).pos;
+        if (abs(ball_pos.x) > max_x)
+        {
+            ret.kind = JumpArc::Contact::Side;
+            ret.tick = tick;
+            break;
+        }
+        if (pos.y < floor_y)
+        {
+            ret.kind = JumpArc::Contact::Land;
+            ret.tick = tick;
+            break;
+        }
+        if ((ball_pos.y >= pos.y) && (pos.dist(ball_pos) < reach))
+        {
+            ret.kind = JumpArc::Contact::Touch;
+            ret.tick = tick;
+            break;
+        }
+        pos += vel * timestep;
+        pos.y -= gravity * timestep * timestep / 2.0_r;
+        vel.y -= gravity * timestep;
+    }
+    return ret;
+}
+
+// Jumps at bouncing and rolling balls from the floor around them, the table scan against
+// the tick by tick flight
+static void BenchJumpArc(const Rules& rules)
+{
+    ArenaModel arena(rules.arena);
+    Simulator sim(rules, arena);
+    BallTrajectory path(sim);
+    const JumpArc arc(rules, (real_t)rules.ROBOT_MAX_JUMP_SPEED);
+    mt19937 rng(20181226);
+    uniform_real_distribution<real_t> unit(-1.0_r, 1.0_r);
+    const real_t reach = (real_t)(rules.BALL_RADIUS + rules.ROBOT_RADIUS) - 0.1_r;
+    const real_t max_x = (real_t)(rules.arena.width / 2.0 - rules.arena.bottom_radius);
+    const real_t max_speed = (real_t)rules.ROBOT_MAX_GROUND_SPEED;
+    Entity takeoff;
+    takeoff.radius = (real_t)rules.ROBOT_RADIUS;
+    takeoff.mass = (real_t)rules.ROBOT_MASS;
+    takeoff.arena_e = (real_t)rules.ROBOT_ARENA_E;
+    takeoff.normal = vec3(0.0_r, 1.0_r, 0.0_r);
+    takeoff.touch = true;
+    takeoff.jump_speed = (real_t)rules.ROBOT_MAX_JUMP_SPEED;
+
+    for (const char* scenario : { "bouncing", "rolling" })
+    {
+        const vector<Entity> starts = BallStarts(rules, scenario, 1000);
+        const int bots = 16;
+        vector<vec3> pos(bots), vel(bots);
+        int counts[4] = {}, mismatches = 0;
+        double scan_ns = 0.0, legacy_ns = 0.0;
+        for (auto& start : starts)
+        {
+            path.reset(start, 0);
+            path.grow(arc.ticks());
+            // Bots around the ball's spot a third of a second ahead, running every way,
+            // the flight starts after the tick they jump on
+            const vec3 spot = path.at(20).pos;
+            for (int i = 0; i < bots; ++i)
+            {
+                Entity bot = takeoff;
+                bot.pos = vec3(spot.x + 4.0_r * unit(rng), (real_t)rules.ROBOT_RADIUS, spot.z + 4.0_r * unit(rng));
+                bot.vel = vec3::clamp(vec3(unit(rng), 0.0_r, unit(rng)) * max_speed, max_speed);
+                bot.target_vel = bot.vel;
+                sim.robot_tick(bot);
+                pos[i] = bot.pos;
+                vel[i] = bot.vel;
+            }
+            JumpArc::Contact scans[bots], legacy[bots];
+            Stopwatch scan_sw;
+            for (int i = 0; i < bots; ++i)
+            {
+                scans[i] = arc.scan(path, 0, pos[i], vel[i], reach, max_x, (real_t)rules.ROBOT_RADIUS);
+            }
+            scan_ns += scan_sw.ns();
+            Stopwatch legacy_sw;
+            for (int i = 0; i < bots; ++i)
+            {
+                legacy[i] = LegacyJumpScan(rules, path, pos[i], vel[i], reach, max_x, (real_t)rules.ROBOT_RADIUS);
+            }
+            legacy_ns += legacy_sw.ns();
+            for (int i = 0; i < bots; ++i)
+            {
+                counts[scans[i].kind] += 1;
+                mismatches += ((scans[i].kind != legacy[i].kind) || (scans[i].tick != legacy[i].tick)) ? 1 : 0;
+            }
+        }
+        const double count = (double)starts.size() * bots;
+        printf("arc %s: %d lanes, table scan %.0f ns, tick by tick %.0f ns, x%.2f; touch %d, side %d, land %d, none %d, %d different\n"
+            , scenario, simd::lanes::width, scan_ns / count, legacy_ns / count, legacy_ns / scan_ns
+            , counts[JumpArc::Contact::Touch], counts[JumpArc::Contact::Side], counts[JumpArc::Contact::Land], counts[JumpArc::Contact::None], mismatches);
+    }
+}
+
+struct BenchmarkEntry
+{
+    const char* name;
+    void(*run)(const Rules& rules);
+};
+
+static const BenchmarkEntry s_benchmarks[] = {
+    { "linal", BenchLinal },
+    { "arena", BenchArenaModel },
+    { "sim", BenchSimulator },
+    { "ticks", BenchBallTicks },
+    { "trajectory", BenchBallTrajectory },
+    { "correct", BenchBallCorrections },
+    { "drift", BenchBallDrift },
+    { "replay", BenchReplay },
+    { "decode", BenchDecoder },
+    { "alloc", BenchAllocations },
+    { "write", BenchWrite },
+    { "wire", BenchWire },
+    { "socket", BenchSocket },
+    { "runner", BenchRunner },
+    { "pool", BenchThreadPool },
+    { "state", BenchWorldState },
+    { "ground", BenchGround },
+    { "arc", BenchJumpArc },
+};
+
+int RunBenchmarks(int argc, char* argv[])
+{
+    rapidjson::Document d;
+    d.Parse(s_default_rules);
+    Rules rules;
+    rules.read(d);
+
+    for (auto& bench : s_benchmarks)
+    {
+        bool selected = (argc == 0);
+        for (int i = 0; i < argc; ++i)
+        {
+            selected = selected || (0 == strcmp(argv[i], bench.name));
+        }
+        if (selected)
+        {
+            printf("== %s\n", bench.name);
+            bench.run(rules);
+        }
+    }
+
+    return 0;
+}
+
+#endif // MY_BENCHMARK
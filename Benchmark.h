@@ -0,0 +1,19 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#ifdef MY_BENCHMARK
+#include <string>
+
+// Runs the benchmarks named on the command line (all of them when none given).
+int RunBenchmarks(int argc, char* argv[]);
+
+// Server stream of a match, the rules line and a line per tick: read from the file
+// (match.jsonl when none given) or made up by the simulator when there is no such file
+std::string MatchStream(const char* file, int ticks);
+#endif
+
+#endif // _BENCHMARK_H_
@@ -0,0 +1,466 @@
+#include "BinaryProtocol.h"
+#include <cstdint>
+#include <cstring>
+using namespace std;
+using namespace model;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Records
+//
+struct WireArena
+{
+    double width;
+    double height;
+    double depth;
+    double bottom_radius;
+    double top_radius;
+    double corner_radius;
+    double goal_top_radius;
+    double goal_width;
+    double goal_height;
+    double goal_depth;
+    double goal_side_radius;
+};
+static_assert(sizeof(WireArena) == 88, "WireArena layout");
+
+struct WireRules
+{
+    int32_t max_tick_count;
+    int32_t team_size;
+    int64_t seed;
+    WireArena arena;
+    int32_t TICKS_PER_SECOND;
+    int32_t MICROTICKS_PER_TICK;
+    int32_t RESET_TICKS;
+    int32_t NITRO_PACK_RESPAWN_TICKS;
+    double ROBOT_MIN_RADIUS;
+    double ROBOT_MAX_RADIUS;
+    double ROBOT_MAX_JUMP_SPEED;
+    double ROBOT_ACCELERATION;
+    double ROBOT_NITRO_ACCELERATION;
+    double ROBOT_MAX_GROUND_SPEED;
+    double ROBOT_ARENA_E;
+    double ROBOT_RADIUS;
+    double ROBOT_MASS;
+    double BALL_ARENA_E;
+    double BALL_RADIUS;
+    double BALL_MASS;
+    double MIN_HIT_E;
+    double MAX_HIT_E;
+    double MAX_ENTITY_SPEED;
+    double MAX_NITRO_AMOUNT;
+    double START_NITRO_AMOUNT;
+    double NITRO_POINT_VELOCITY_CHANGE;
+    double NITRO_PACK_X;
+    double NITRO_PACK_Y;
+    double NITRO_PACK_Z;
+    double NITRO_PACK_RADIUS;
+    double NITRO_PACK_AMOUNT;
+    double GRAVITY;
+};
+static_assert(sizeof(WireRules) == 16 + 88 + 16 + 24 * 8, "WireRules layout");
+
+struct WireGame
+{
+    int32_t current_tick;
+    int32_t players;
+    int32_t robots;
+    int32_t nitro_packs;
+};
+static_assert(sizeof(WireGame) == 16, "WireGame layout");
+
+struct WirePlayer
+{
+    int32_t id;
+    int32_t score;
+    uint8_t me;
+    uint8_t strategy_crashed;
+    uint8_t pad[6];
+};
+static_assert(sizeof(WirePlayer) == 16, "WirePlayer layout");
+
+struct WireRobot
+{
+    int32_t id;
+    int32_t player_id;
+    uint8_t is_teammate;
+    uint8_t touch;
+    uint8_t pad[6];
+    double x;
+    double y;
+    double z;
+    double velocity_x;
+    double velocity_y;
+    double velocity_z;
+    double radius;
+    double nitro_amount;
+    double touch_normal_x;
+    double touch_normal_y;
+    double touch_normal_z;
+};
+static_assert(sizeof(WireRobot) == 16 + 11 * 8, "WireRobot layout");
+
+struct WireNitroPack
+{
+    int32_t id;
+    int32_t respawn_ticks;
+    uint8_t alive;
+    uint8_t pad[7];
+    double x;
+    double y;
+    double z;
+    double radius;
+};
+static_assert(sizeof(WireNitroPack) == 16 + 4 * 8, "WireNitroPack layout");
+
+struct WireBall
+{
+    double x;
+    double y;
+    double z;
+    double velocity_x;
+    double velocity_y;
+    double velocity_z;
+    double radius;
+};
+static_assert(sizeof(WireBall) == 7 * 8, "WireBall layout");
+
+struct WireAnswer
+{
+    uint32_t actions;
+    uint32_t rendering;                 // bytes of the custom rendering after the actions
+};
+static_assert(sizeof(WireAnswer) == 8, "WireAnswer layout");
+
+struct WireAction
+{
+    int32_t id;
+    uint8_t use_nitro;
+    uint8_t pad[3];
+    double target_velocity_x;
+    double target_velocity_y;
+    double target_velocity_z;
+    double jump_speed;
+};
+static_assert(sizeof(WireAction) == 8 + 4 * 8, "WireAction layout");
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Frames
+//
+size_t Begin(vector<char>& out)
+{
+    const size_t start = out.size();
+    out.resize(start + BinaryProtocol::header_size);
+    return start;
+}
+
+template <class T>
+void Put(const T& record, vector<char>& out)
+{
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    memcpy(out.data() + at, &record, sizeof(T));
+}
+
+void End(size_t start, vector<char>& out)
+{
+    const uint32_t size = (uint32_t)(out.size() - start - BinaryProtocol::header_size);
+    memcpy(out.data() + start, &size, sizeof(size));
+}
+
+// Records read one after another off a payload
+struct Cursor
+{
+    const char* at;
+    const char* end;
+
+    template <class T>
+    bool get(T& record)
+    {
+        if ((size_t)(end - at) < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&record, at, sizeof(T));
+        at += sizeof(T);
+        return true;
+    }
+};
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+void BinaryProtocol::write(const Rules& rules, vector<char>& out)
+{
+    const size_t start = Begin(out);
+    WireRules w = {};
+    w.max_tick_count = rules.max_tick_count;
+    w.team_size = rules.team_size;
+    w.seed = rules.seed;
+    w.arena.width = rules.arena.width;
+    w.arena.height = rules.arena.height;
+    w.arena.depth = rules.arena.depth;
+    w.arena.bottom_radius = rules.arena.bottom_radius;
+    w.arena.top_radius = rules.arena.top_radius;
+    w.arena.corner_radius = rules.arena.corner_radius;
+    w.arena.goal_top_radius = rules.arena.goal_top_radius;
+    w.arena.goal_width = rules.arena.goal_width;
+    w.arena.goal_height = rules.arena.goal_height;
+    w.arena.goal_depth = rules.arena.goal_depth;
+    w.arena.goal_side_radius = rules.arena.goal_side_radius;
+    w.TICKS_PER_SECOND = rules.TICKS_PER_SECOND;
+    w.MICROTICKS_PER_TICK = rules.MICROTICKS_PER_TICK;
+    w.RESET_TICKS = rules.RESET_TICKS;
+    w.NITRO_PACK_RESPAWN_TICKS = rules.NITRO_PACK_RESPAWN_TICKS;
+    w.ROBOT_MIN_RADIUS = rules.ROBOT_MIN_RADIUS;
+    w.ROBOT_MAX_RADIUS = rules.ROBOT_MAX_RADIUS;
+    w.ROBOT_MAX_JUMP_SPEED = rules.ROBOT_MAX_JUMP_SPEED;
+    w.ROBOT_ACCELERATION = rules.ROBOT_ACCELERATION;
+    w.ROBOT_NITRO_ACCELERATION = rules.ROBOT_NITRO_ACCELERATION;
+    w.ROBOT_MAX_GROUND_SPEED = rules.ROBOT_MAX_GROUND_SPEED;
+    w.ROBOT_ARENA_E = rules.ROBOT_ARENA_E;
+    w.ROBOT_RADIUS = rules.ROBOT_RADIUS;
+    w.ROBOT_MASS = rules.ROBOT_MASS;
+    w.BALL_ARENA_E = rules.BALL_ARENA_E;
+    w.BALL_RADIUS = rules.BALL_RADIUS;
+    w.BALL_MASS = rules.BALL_MASS;
+    w.MIN_HIT_E = rules.MIN_HIT_E;
+    w.MAX_HIT_E = rules.MAX_HIT_E;
+    w.MAX_ENTITY_SPEED = rules.MAX_ENTITY_SPEED;
+    w.MAX_NITRO_AMOUNT = rules.MAX_NITRO_AMOUNT;
+    w.START_NITRO_AMOUNT = rules.START_NITRO_AMOUNT;
+    w.NITRO_POINT_VELOCITY_CHANGE = rules.NITRO_POINT_VELOCITY_CHANGE;
+    w.NITRO_PACK_X = rules.NITRO_PACK_X;
+    w.NITRO_PACK_Y = rules.NITRO_PACK_Y;
+    w.NITRO_PACK_Z = rules.NITRO_PACK_Z;
+    w.NITRO_PACK_RADIUS = rules.NITRO_PACK_RADIUS;
+    w.NITRO_PACK_AMOUNT = rules.NITRO_PACK_AMOUNT;
+    w.GRAVITY = rules.GRAVITY;
+    Put(w, out);
+    End(start, out);
+}
+
+void BinaryProtocol::write(const Game& game, vector<char>& out)
+{
+    const size_t start = Begin(out);
+    Put(WireGame{ game.current_tick, (int32_t)game.players.size(), (int32_t)game.robots.size(), (int32_t)game.nitro_packs.size() }, out);
+    for (const Player& player : game.players)
+    {
+        WirePlayer w = {};
+        w.id = player.id;
+        w.score = player.score;
+        w.me = player.me;
+        w.strategy_crashed = player.strategy_crashed;
+        Put(w, out);
+    }
+    for (const Robot& robot : game.robots)
+    {
+        WireRobot w = {};
+        w.id = robot.id;
+        w.player_id = robot.player_id;
+        w.is_teammate = robot.is_teammate;
+        w.touch = robot.touch;
+        w.x = robot.x;
+        w.y = robot.y;
+        w.z = robot.z;
+        w.velocity_x = robot.velocity_x;
+        w.velocity_y = robot.velocity_y;
+        w.velocity_z = robot.velocity_z;
+        w.radius = robot.radius;
+        w.nitro_amount = robot.nitro_amount;
+        if (robot.touch)
+        {
+            w.touch_normal_x = robot.touch_normal_x;
+            w.touch_normal_y = robot.touch_normal_y;
+            w.touch_normal_z = robot.touch_normal_z;
+        }
+        Put(w, out);
+    }
+    for (const NitroPack& pack : game.nitro_packs)
+    {
+        WireNitroPack w = {};
+        w.id = pack.id;
+        w.alive = pack.alive;
+        w.respawn_ticks = pack.alive ? 0 : pack.respawn_ticks;
+        w.x = pack.x;
+        w.y = pack.y;
+        w.z = pack.z;
+        w.radius = pack.radius;
+        Put(w, out);
+    }
+    const Ball& ball = game.ball;
+    Put(WireBall{ ball.x, ball.y, ball.z, ball.velocity_x, ball.velocity_y, ball.velocity_z, ball.radius }, out);
+    End(start, out);
+}
+
+void BinaryProtocol::write(const unordered_map<int, Action>& actions, const string& custom_rendering, vector<char>& out)
+{
+    const size_t start = Begin(out);
+    Put(WireAnswer{ (uint32_t)actions.size(), (uint32_t)custom_rendering.size() }, out);
+    for (const auto& item : actions)
+    {
+        const Action& action = item.second;
+        WireAction w = {};
+        w.id = item.first;
+        w.use_nitro = action.use_nitro;
+        w.target_velocity_x = action.target_velocity_x;
+        w.target_velocity_y = action.target_velocity_y;
+        w.target_velocity_z = action.target_velocity_z;
+        w.jump_speed = action.jump_speed;
+        Put(w, out);
+    }
+    out.insert(out.end(), custom_rendering.begin(), custom_rendering.end());
+    End(start, out);
+}
+
+bool BinaryProtocol::read(string_view payload, Rules& rules)
+{
+    Cursor cursor = { payload.data(), payload.data() + payload.size() };
+    WireRules w;
+    if (!cursor.get(w) || cursor.at != cursor.end)
+    {
+        return false;
+    }
+    rules.max_tick_count = w.max_tick_count;
+    rules.team_size = w.team_size;
+    rules.seed = w.seed;
+    rules.arena.width = w.arena.width;
+    rules.arena.height = w.arena.height;
+    rules.arena.depth = w.arena.depth;
+    rules.arena.bottom_radius = w.arena.bottom_radius;
+    rules.arena.top_radius = w.arena.top_radius;
+    rules.arena.corner_radius = w.arena.corner_radius;
+    rules.arena.goal_top_radius = w.arena.goal_top_radius;
+    rules.arena.goal_width = w.arena.goal_width;
+    rules.arena.goal_height = w.arena.goal_height;
+    rules.arena.goal_depth = w.arena.goal_depth;
+    rules.arena.goal_side_radius = w.arena.goal_side_radius;
+    rules.TICKS_PER_SECOND = w.TICKS_PER_SECOND;
+    rules.MICROTICKS_PER_TICK = w.MICROTICKS_PER_TICK;
+    rules.RESET_TICKS = w.RESET_TICKS;
+    rules.NITRO_PACK_RESPAWN_TICKS = w.NITRO_PACK_RESPAWN_TICKS;
+    rules.ROBOT_MIN_RADIUS = w.ROBOT_MIN_RADIUS;
+    rules.ROBOT_MAX_RADIUS = w.ROBOT_MAX_RADIUS;
+    rules.ROBOT_MAX_JUMP_SPEED = w.ROBOT_MAX_JUMP_SPEED;
+    rules.ROBOT_ACCELERATION = w.ROBOT_ACCELERATION;
+    rules.ROBOT_NITRO_ACCELERATION = w.ROBOT_NITRO_ACCELERATION;
+    rules.ROBOT_MAX_GROUND_SPEED = w.ROBOT_MAX_GROUND_SPEED;
+    rules.ROBOT_ARENA_E = w.ROBOT_ARENA_E;
+    rules.ROBOT_RADIUS = w.ROBOT_RADIUS;
+    rules.ROBOT_MASS = w.ROBOT_MASS;
+    rules.BALL_ARENA_E = w.BALL_ARENA_E;
+    rules.BALL_RADIUS = w.BALL_RADIUS;
+    rules.BALL_MASS = w.BALL_MASS;
+    rules.MIN_HIT_E = w.MIN_HIT_E;
+    rules.MAX_HIT_E = w.MAX_HIT_E;
+    rules.MAX_ENTITY_SPEED = w.MAX_ENTITY_SPEED;
+    rules.MAX_NITRO_AMOUNT = w.MAX_NITRO_AMOUNT;
+    rules.START_NITRO_AMOUNT = w.START_NITRO_AMOUNT;
+    rules.NITRO_POINT_VELOCITY_CHANGE = w.NITRO_POINT_VELOCITY_CHANGE;
+    rules.NITRO_PACK_X = w.NITRO_PACK_X;
+    rules.NITRO_PACK_Y = w.NITRO_PACK_Y;
+    rules.NITRO_PACK_Z = w.NITRO_PACK_Z;
+    rules.NITRO_PACK_RADIUS = w.NITRO_PACK_RADIUS;
+    rules.NITRO_PACK_AMOUNT = w.NITRO_PACK_AMOUNT;
+    rules.GRAVITY = w.GRAVITY;
+    return true;
+}
+
+bool BinaryProtocol::read(string_view payload, Game& game)
+{
+    Cursor cursor = { payload.data(), payload.data() + payload.size() };
+    WireGame header;
+    if (!cursor.get(header) || header.players < 0 || header.robots < 0 || header.nitro_packs < 0
+        || (size_t)(cursor.end - cursor.at) != header.players * sizeof(WirePlayer) + header.robots * sizeof(WireRobot)
+            + header.nitro_packs * sizeof(WireNitroPack) + sizeof(WireBall))
+    {
+        return false;
+    }
+
+    game.current_tick = header.current_tick;
+    game.players.resize(header.players);
+    for (Player& player : game.players)
+    {
+        WirePlayer w;
+        cursor.get(w);
+        player.id = w.id;
+        player.me = (0 != w.me);
+        player.strategy_crashed = (0 != w.strategy_crashed);
+        player.score = w.score;
+    }
+    game.robots.resize(header.robots);
+    for (Robot& robot : game.robots)
+    {
+        WireRobot w;
+        cursor.get(w);
+        robot.id = w.id;
+        robot.player_id = w.player_id;
+        robot.is_teammate = (0 != w.is_teammate);
+        robot.x = w.x;
+        robot.y = w.y;
+        robot.z = w.z;
+        robot.velocity_x = w.velocity_x;
+        robot.velocity_y = w.velocity_y;
+        robot.velocity_z = w.velocity_z;
+        robot.radius = w.radius;
+        robot.nitro_amount = w.nitro_amount;
+        robot.touch = (0 != w.touch);
+        robot.touch_normal_x = w.touch_normal_x;
+        robot.touch_normal_y = w.touch_normal_y;
+        robot.touch_normal_z = w.touch_normal_z;
+    }
+    game.nitro_packs.resize(header.nitro_packs);
+    for (NitroPack& pack : game.nitro_packs)
+    {
+        WireNitroPack w;
+        cursor.get(w);
+        pack.id = w.id;
+        pack.x = w.x;
+        pack.y = w.y;
+        pack.z = w.z;
+        pack.radius = w.radius;
+        pack.alive = (0 != w.alive);
+        pack.respawn_ticks = w.respawn_ticks;
+    }
+    WireBall w;
+    cursor.get(w);
+    game.ball.x = w.x;
+    game.ball.y = w.y;
+    game.ball.z = w.z;
+    game.ball.velocity_x = w.velocity_x;
+    game.ball.velocity_y = w.velocity_y;
+    game.ball.velocity_z = w.velocity_z;
+    game.ball.radius = w.radius;
+    return true;
+}
+
+bool BinaryProtocol::read(string_view payload, unordered_map<int, Action>& actions, string& custom_rendering)
+{
+    Cursor cursor = { payload.data(), payload.data() + payload.size() };
+    WireAnswer header;
+    if (!cursor.get(header) || (size_t)(cursor.end - cursor.at) != header.actions * sizeof(WireAction) + header.rendering)
+    {
+        return false;
+    }
+
+    actions.clear();
+    for (uint32_t i = 0; i < header.actions; ++i)
+    {
+        WireAction w;
+        cursor.get(w);
+        Action& action = actions[w.id];
+        action.target_velocity_x = w.target_velocity_x;
+        action.target_velocity_y = w.target_velocity_y;
+        action.target_velocity_z = w.target_velocity_z;
+        action.jump_speed = w.jump_speed;
+        action.use_nitro = (0 != w.use_nitro);
+    }
+    custom_rendering.assign(cursor.at, header.rendering);
+    return true;
+}
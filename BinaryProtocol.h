@@ -0,0 +1,45 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _BINARY_PROTOCOL_H_
+#define _BINARY_PROTOCOL_H_
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "model/Action.h"
+#include "model/Game.h"
+#include "model/Rules.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Binary mode of the client protocol. The official server speaks JSON only, this is for the
+// stand-in server (see StandInServer.h). The client sends "binary" instead of "json" and then
+// the token line as usual, from there on both sides send frames: a uint32 payload size, then
+// the payload, fixed-layout records with natural alignment and no hidden padding.
+//   rules:  one rules record
+//   game:   game header, its players, robots and nitro packs, the ball
+//   answer: answer header, an action per robot, the custom rendering text
+// Records are copied with memcpy and numbers are not swapped, both ends have to be
+// little-endian (x86 and ARM as they are normally run).
+//
+class BinaryProtocol
+{
+public:
+    static constexpr size_t header_size = 4;
+
+    // Whole frames, appended to the output
+    static void write(const model::Rules& rules, std::vector<char>& out);
+    static void write(const model::Game& game, std::vector<char>& out);
+    static void write(const std::unordered_map<int, model::Action>& actions, const std::string& custom_rendering, std::vector<char>& out);
+
+    // Payload of a frame (see LineBuffer::next_frame()), false if its size does not fit the records.
+    // Vectors and the map are filled over, they keep their memory.
+    static bool read(std::string_view payload, model::Rules& rules);
+    static bool read(std::string_view payload, model::Game& game);
+    static bool read(std::string_view payload, std::unordered_map<int, model::Action>& actions, std::string& custom_rendering);
+};
+
+#endif // _BINARY_PROTOCOL_H_
@@ -0,0 +1,488 @@
+#include "JsonDecoder.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "rapidjson/reader.h"
+using namespace std;
+using namespace model;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Field tables
+//
+struct Scalar
+{
+    enum Kind
+    {
+        Null,
+        Bool,
+        Int,
+        Double,
+        String
+    };
+
+    Kind kind = Null;
+    bool b = false;
+    int64_t i = 0;
+    double d = 0.0;
+};
+
+struct Schema;
+
+struct Field
+{
+    const char* name;
+    size_t length;
+    bool (*set)(void* object, const Scalar& value);         // scalars
+    const Schema* schema;                                   // objects and arrays of objects
+    void* (*element)(void* object, size_t index);           // the object, or the element of the array (grown as needed)
+    void (*trim)(void* object, size_t count);               // arrays only, cuts them to the elements read
+};
+
+// Keys go into 128 slots by their length and a few of their characters,
+// the seed is the first one that gives every key of the table a slot of its own
+struct Schema
+{
+    const Field* fields = nullptr;
+    size_t count = 0;
+    uint64_t seed = 0;
+    signed char slots[128] = {};
+};
+
+constexpr uint64_t c_mix = 0x9E3779B97F4A7C15ull;
+
+constexpr size_t Length(const char* key)
+{
+    size_t length = 0;
+    while (key[length])
+    {
+        ++length;
+    }
+    return length;
+}
+
+constexpr unsigned Slot(const char* key, size_t length, uint64_t seed)
+{
+    const uint64_t bits = (uint64_t)length
+        | ((uint64_t)(unsigned char)key[0] << 8)
+        | ((uint64_t)(unsigned char)key[1 % length] << 16)
+        | ((uint64_t)(unsigned char)key[length / 2] << 24)
+        | ((uint64_t)(unsigned char)key[length - 1] << 32);
+    return (unsigned)(((bits ^ (seed * c_mix)) * c_mix) >> 57);
+}
+
+template <size_t N>
+constexpr Schema MakeSchema(const Field(&fields)[N])
+{
+    Schema schema;
+    schema.fields = fields;
+    schema.count = N;
+    for (uint64_t seed = 0; ; ++seed)
+    {
+        // No seed found soon means two keys the hash can not tell apart, a compile error
+        if (seed > 100000)
+        {
+            throw "no perfect hash for the field table";
+        }
+
+        uint64_t used[2] = {};
+        bool perfect = true;
+        for (size_t i = 0; i < N && perfect; ++i)
+        {
+            const unsigned slot = Slot(fields[i].name, fields[i].length, seed);
+            perfect = !(used[slot / 64] & (1ull << (slot % 64)));
+            used[slot / 64] |= 1ull << (slot % 64);
+        }
+        if (perfect)
+        {
+            schema.seed = seed;
+            break;
+        }
+    }
+    for (size_t i = 0; i < 128; ++i)
+    {
+        schema.slots[i] = -1;
+    }
+    for (size_t i = 0; i < N; ++i)
+    {
+        schema.slots[Slot(fields[i].name, fields[i].length, schema.seed)] = (signed char)i;
+    }
+    return schema;
+}
+
+const Field* Find(const Schema& schema, const char* key, size_t length)
+{
+    if (0 == length)
+    {
+        return nullptr;
+    }
+    const int index = schema.slots[Slot(key, length, schema.seed)];
+    if (index < 0)
+    {
+        return nullptr;
+    }
+    const Field& field = schema.fields[index];
+    return (field.length == length && 0 == memcmp(field.name, key, length)) ? &field : nullptr;
+}
+
+bool Read(const Scalar& value, int& out)
+{
+    out = (int)value.i;
+    return Scalar::Int == value.kind;
+}
+
+bool Read(const Scalar& value, long long& out)
+{
+    out = (long long)value.i;
+    return Scalar::Int == value.kind;
+}
+
+bool Read(const Scalar& value, double& out)
+{
+    out = (Scalar::Int == value.kind) ? (double)value.i : value.d;
+    return (Scalar::Int == value.kind) || (Scalar::Double == value.kind);
+}
+
+bool Read(const Scalar& value, bool& out)
+{
+    out = value.b;
+    return Scalar::Bool == value.kind;
+}
+
+template <class T>
+void* Grow(vector<T>& items, size_t index)
+{
+    if (index >= items.size())
+    {
+        items.resize(index + 1);
+    }
+    items[index] = T();
+    return &items[index];
+}
+
+#define DECODER_FIELD(type, name) \
+    { #name, Length(#name), [](void* object, const Scalar& value) { return Read(value, static_cast<type*>(object)->name); }, nullptr, nullptr, nullptr }
+
+#define DECODER_OBJECT(type, name, schema) \
+    { #name, Length(#name), nullptr, &schema, [](void* object, size_t) -> void* { return &static_cast<type*>(object)->name; }, nullptr }
+
+#define DECODER_ARRAY(type, name, schema) \
+    { #name, Length(#name), nullptr, &schema, \
+        [](void* object, size_t index) { return Grow(static_cast<type*>(object)->name, index); }, \
+        [](void* object, size_t count) { static_cast<type*>(object)->name.resize(count); } }
+
+constexpr Field c_player_fields[] = {
+    DECODER_FIELD(Player, id),
+    DECODER_FIELD(Player, me),
+    DECODER_FIELD(Player, strategy_crashed),
+    DECODER_FIELD(Player, score),
+};
+constexpr Schema c_player = MakeSchema(c_player_fields);
+
+// The touch normal is null for a robot touching nothing, it stays zero then
+bool ReadNormal(double& out, const Scalar& value)
+{
+    if (Scalar::Null == value.kind)
+    {
+        out = 0.0;
+        return true;
+    }
+    return Read(value, out);
+}
+
+#define DECODER_NORMAL(name) \
+    { #name, Length(#name), [](void* object, const Scalar& value) { return ReadNormal(static_cast<Robot*>(object)->name, value); }, nullptr, nullptr, nullptr }
+
+constexpr Field c_robot_fields[] = {
+    DECODER_FIELD(Robot, id),
+    DECODER_FIELD(Robot, player_id),
+    DECODER_FIELD(Robot, is_teammate),
+    DECODER_FIELD(Robot, x),
+    DECODER_FIELD(Robot, y),
+    DECODER_FIELD(Robot, z),
+    DECODER_FIELD(Robot, velocity_x),
+    DECODER_FIELD(Robot, velocity_y),
+    DECODER_FIELD(Robot, velocity_z),
+    DECODER_FIELD(Robot, radius),
+    DECODER_FIELD(Robot, nitro_amount),
+    DECODER_FIELD(Robot, touch),
+    DECODER_NORMAL(touch_normal_x),
+    DECODER_NORMAL(touch_normal_y),
+    DECODER_NORMAL(touch_normal_z),
+};
+constexpr Schema c_robot = MakeSchema(c_robot_fields);
+
+// respawn_ticks is null for a pack lying there
+bool ReadRespawn(void* object, const Scalar& value)
+{
+    NitroPack& pack = *static_cast<NitroPack*>(object);
+    pack.alive = (Scalar::Null == value.kind);
+    return pack.alive || Read(value, pack.respawn_ticks);
+}
+
+constexpr Field c_nitro_pack_fields[] = {
+    DECODER_FIELD(NitroPack, id),
+    DECODER_FIELD(NitroPack, x),
+    DECODER_FIELD(NitroPack, y),
+    DECODER_FIELD(NitroPack, z),
+    DECODER_FIELD(NitroPack, radius),
+    { "respawn_ticks", Length("respawn_ticks"), ReadRespawn, nullptr, nullptr, nullptr },
+};
+constexpr Schema c_nitro_pack = MakeSchema(c_nitro_pack_fields);
+
+constexpr Field c_ball_fields[] = {
+    DECODER_FIELD(Ball, x),
+    DECODER_FIELD(Ball, y),
+    DECODER_FIELD(Ball, z),
+    DECODER_FIELD(Ball, velocity_x),
+    DECODER_FIELD(Ball, velocity_y),
+    DECODER_FIELD(Ball, velocity_z),
+    DECODER_FIELD(Ball, radius),
+};
+constexpr Schema c_ball = MakeSchema(c_ball_fields);
+
+constexpr Field c_game_fields[] = {
+    DECODER_FIELD(Game, current_tick),
+    DECODER_ARRAY(Game, players, c_player),
+    DECODER_ARRAY(Game, robots, c_robot),
+    DECODER_ARRAY(Game, nitro_packs, c_nitro_pack),
+    DECODER_OBJECT(Game, ball, c_ball),
+};
+constexpr Schema c_game = MakeSchema(c_game_fields);
+
+constexpr Field c_arena_fields[] = {
+    DECODER_FIELD(Arena, width),
+    DECODER_FIELD(Arena, height),
+    DECODER_FIELD(Arena, depth),
+    DECODER_FIELD(Arena, bottom_radius),
+    DECODER_FIELD(Arena, top_radius),
+    DECODER_FIELD(Arena, corner_radius),
+    DECODER_FIELD(Arena, goal_top_radius),
+    DECODER_FIELD(Arena, goal_width),
+    DECODER_FIELD(Arena, goal_height),
+    DECODER_FIELD(Arena, goal_depth),
+    DECODER_FIELD(Arena, goal_side_radius),
+};
+constexpr Schema c_arena = MakeSchema(c_arena_fields);
+
+constexpr Field c_rules_fields[] = {
+    DECODER_FIELD(Rules, max_tick_count),
+    DECODER_OBJECT(Rules, arena, c_arena),
+    DECODER_FIELD(Rules, team_size),
+    DECODER_FIELD(Rules, seed),
+    DECODER_FIELD(Rules, ROBOT_MIN_RADIUS),
+    DECODER_FIELD(Rules, ROBOT_MAX_RADIUS),
+    DECODER_FIELD(Rules, ROBOT_MAX_JUMP_SPEED),
+    DECODER_FIELD(Rules, ROBOT_ACCELERATION),
+    DECODER_FIELD(Rules, ROBOT_NITRO_ACCELERATION),
+    DECODER_FIELD(Rules, ROBOT_MAX_GROUND_SPEED),
+    DECODER_FIELD(Rules, ROBOT_ARENA_E),
+    DECODER_FIELD(Rules, ROBOT_RADIUS),
+    DECODER_FIELD(Rules, ROBOT_MASS),
+    DECODER_FIELD(Rules, TICKS_PER_SECOND),
+    DECODER_FIELD(Rules, MICROTICKS_PER_TICK),
+    DECODER_FIELD(Rules, RESET_TICKS),
+    DECODER_FIELD(Rules, BALL_ARENA_E),
+    DECODER_FIELD(Rules, BALL_RADIUS),
+    DECODER_FIELD(Rules, BALL_MASS),
+    DECODER_FIELD(Rules, MIN_HIT_E),
+    DECODER_FIELD(Rules, MAX_HIT_E),
+    DECODER_FIELD(Rules, MAX_ENTITY_SPEED),
+    DECODER_FIELD(Rules, MAX_NITRO_AMOUNT),
+    DECODER_FIELD(Rules, START_NITRO_AMOUNT),
+    DECODER_FIELD(Rules, NITRO_POINT_VELOCITY_CHANGE),
+    DECODER_FIELD(Rules, NITRO_PACK_X),
+    DECODER_FIELD(Rules, NITRO_PACK_Y),
+    DECODER_FIELD(Rules, NITRO_PACK_Z),
+    DECODER_FIELD(Rules, NITRO_PACK_RADIUS),
+    DECODER_FIELD(Rules, NITRO_PACK_AMOUNT),
+    DECODER_FIELD(Rules, NITRO_PACK_RESPAWN_TICKS),
+    DECODER_FIELD(Rules, GRAVITY),
+};
+constexpr Schema c_rules = MakeSchema(c_rules_fields);
+
+#undef DECODER_FIELD
+#undef DECODER_OBJECT
+#undef DECODER_ARRAY
+
+//////////////////////////////////////////////////////////////////////////
+//
+// SAX handler, a stack of the objects and arrays being filled.
+// Whatever the tables do not know is skipped, only its depth is counted.
+//
+class Handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler>
+{
+public:
+    Handler(const Schema& schema, void* object) :
+        m_root(&schema),
+        m_object(object)
+    {
+    }
+
+    bool Null() { return value(Scalar()); }
+    bool Bool(bool b) { Scalar v; v.kind = Scalar::Bool; v.b = b; return value(v); }
+    bool Int(int i) { return integer(i); }
+    bool Uint(unsigned u) { return integer(u); }
+    bool Int64(int64_t i) { return integer(i); }
+    bool Uint64(uint64_t u) { return integer((int64_t)u); }
+    bool Double(double d) { Scalar v; v.kind = Scalar::Double; v.d = d; return value(v); }
+    bool String(const char*, rapidjson::SizeType, bool) { Scalar v; v.kind = Scalar::String; return value(v); }
+
+    bool Key(const char* key, rapidjson::SizeType length, bool)
+    {
+        m_field = m_skip ? nullptr : Find(*m_stack[m_depth - 1].schema, key, length);
+        return true;
+    }
+
+    bool StartObject()
+    {
+        if (m_skip)
+        {
+            ++m_skip;
+            return true;
+        }
+        if (0 == m_depth)
+        {
+            return push(m_root, m_object, nullptr);
+        }
+
+        Frame& top = m_stack[m_depth - 1];
+        if (top.array)
+        {
+            return push(top.array->schema, top.array->element(top.object, top.count++), nullptr);
+        }
+        const Field* field = take();
+        if (!field)
+        {
+            ++m_skip;
+            return true;
+        }
+        return field->schema && !field->trim && push(field->schema, field->element(top.object, 0), nullptr);
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        if (m_skip)
+        {
+            --m_skip;
+        }
+        else
+        {
+            --m_depth;
+        }
+        return true;
+    }
+
+    bool StartArray()
+    {
+        if (m_skip)
+        {
+            ++m_skip;
+            return true;
+        }
+        if (0 == m_depth || m_stack[m_depth - 1].array)
+        {
+            return false;
+        }
+        const Field* field = take();
+        if (!field)
+        {
+            ++m_skip;
+            return true;
+        }
+        return field->trim && push(nullptr, m_stack[m_depth - 1].object, field);
+    }
+
+    bool EndArray(rapidjson::SizeType)
+    {
+        if (m_skip)
+        {
+            --m_skip;
+            return true;
+        }
+        const Frame& top = m_stack[--m_depth];
+        top.array->trim(top.object, top.count);
+        return true;
+    }
+
+private:
+    // An object being filled, or an array of the object (count elements so far)
+    struct Frame
+    {
+        const Schema* schema;
+        void* object;
+        const Field* array;
+        size_t count;
+    };
+
+    bool push(const Schema* schema, void* object, const Field* array)
+    {
+        if (m_depth == sizeof(m_stack) / sizeof(m_stack[0]))
+        {
+            return false;
+        }
+        m_stack[m_depth++] = { schema, object, array, 0 };
+        return true;
+    }
+
+    const Field* take()
+    {
+        const Field* field = m_field;
+        m_field = nullptr;
+        return field;
+    }
+
+    bool integer(int64_t i)
+    {
+        Scalar v;
+        v.kind = Scalar::Int;
+        v.i = i;
+        return value(v);
+    }
+
+    bool value(const Scalar& v)
+    {
+        if (m_skip)
+        {
+            return true;
+        }
+        if (0 == m_depth || m_stack[m_depth - 1].array)
+        {
+            return false;
+        }
+        const Field* field = take();
+        return !field || (field->set && field->set(m_stack[m_depth - 1].object, v));
+    }
+
+    const Schema* m_root;
+    void* m_object;
+    Frame m_stack[4];
+    int m_depth = 0;
+    int m_skip = 0;                     // depth inside something skipped
+    const Field* m_field = nullptr;     // of the key just read, null for an unknown one
+};
+
+bool Decode(char* json, const Schema& schema, void* object)
+{
+    Handler handler(schema, object);
+    rapidjson::Reader reader;
+    rapidjson::InsituStringStream stream(json);
+    return !reader.Parse<rapidjson::kParseInsituFlag>(stream, handler).IsError();
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+bool JsonDecoder::read(char* json, Game& game)
+{
+    return Decode(json, c_game, &game);
+}
+
+bool JsonDecoder::read(char* json, Rules& rules)
+{
+    return Decode(json, c_rules, &rules);
+}
@@ -0,0 +1,30 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _JSON_DECODER_H_
+#define _JSON_DECODER_H_
+
+#include "model/Game.h"
+#include "model/Rules.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Server lines straight into the model, no DOM on the way: the SAX events of rapidjson
+// are matched against field tables of the model structs, keys are looked up by a perfect
+// hash made at compile time. The line is parsed in place (it has to end with '\0' and gets
+// overwritten). Vectors in the model are filled over, they keep their memory, so nothing is
+// allocated once they are big enough. Unknown keys are skipped, missing ones keep the values
+// they had, except the elements of arrays which start zeroed (a robot not touching anything
+// gets a zero touch normal, null or missing). Same values as Game::read() and Rules::read()
+// from the DOM, which leaves the normal of such a robot unread.
+//
+class JsonDecoder
+{
+public:
+    // false for malformed JSON or a value of a wrong type, the model is filled halfway then
+    static bool read(char* json, model::Game& game);
+    static bool read(char* json, model::Rules& rules);
+};
+
+#endif // _JSON_DECODER_H_
@@ -0,0 +1,82 @@
+#include "JumpArc.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace linal;
+using namespace std;
+using simd::lanes;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+JumpArc::JumpArc(const model::Rules& rules, real_t jump_speed)
+{
+    const real_t timestep = 1.0_r / (real_t)rules.TICKS_PER_SECOND;
+    const real_t gravity = (real_t)rules.GRAVITY;
+    m_ticks = max((int)floor(jump_speed / gravity / timestep), 1);
+
+    const size_t width = (size_t)lanes::width;
+    const size_t rows = (m_ticks + width - 1) / width * width;
+    m_drop.assign(rows, 0.0_r);
+    m_run.assign(rows, 0.0_r);
+    for (int tick = 1; tick < m_ticks; ++tick)
+    {
+        // A microtick moves by the speed and then the drop, the ticks add up to the same parabola
+        const real_t air_time = (real_t)(tick - 1) * timestep;
+        m_run[tick] = air_time;
+        m_drop[tick] = gravity * air_time * air_time / 2.0_r;
+    }
+}
+
+JumpArc::Contact JumpArc::scan(const BallTrajectory& ball, int first_tick, const vec3& from, const vec3& vel
+    , real_t reach, real_t max_x, real_t floor_y) const
+{
+    const int width = lanes::width;
+    real_t bx[lanes::width], by[lanes::width], bz[lanes::width];
+    const lanes from_x = lanes::splat(from.x), from_y = lanes::splat(from.y), from_z = lanes::splat(from.z);
+    const lanes vel_x = lanes::splat(vel.x), vel_y = lanes::splat(vel.y), vel_z = lanes::splat(vel.z);
+    const lanes reach_sq = lanes::splat(reach * reach);
+    const lanes limit = lanes::splat(max_x);
+    const lanes floor = lanes::splat(floor_y);
+
+    // Rows the ball is not predicted for are left out like the ones after the flight
+    const int ticks = min(m_ticks, ball.last_tick() - first_tick + 1);
+    Contact ret;
+    for (int row = 0; row < ticks; row += width)
+    {
+        // Rows out of the flight look at the ball of its last tick and are masked out
+        for (int i = 0; i < width; ++i)
+        {
+            const int tick = min(max(row + i, 1), ticks - 1);
+            const Entity e = ball.at(first_tick + tick);
+            bx[i] = e.pos.x, by[i] = e.pos.y, bz[i] = e.pos.z;
+        }
+        const lanes run = lanes::load(&m_run[row]);
+        const lanes x = from_x + vel_x * run;
+        const lanes y = from_y + vel_y * run - lanes::load(&m_drop[row]);
+        const lanes z = from_z + vel_z * run;
+        const lanes ball_x = lanes::load(bx), ball_y = lanes::load(by), ball_z = lanes::load(bz);
+        const lanes dx = x - ball_x, dy = y - ball_y, dz = z - ball_z;
+
+        const simd::mask side = limit < abs(ball_x);
+        const simd::mask touch = (y <= ball_y) & ((dx * dx + dy * dy + dz * dz) < reach_sq);
+        const simd::mask land = y < floor;
+        const simd::mask any = side | touch | land;
+        if (!simd::any(any))
+        {
+            continue;
+        }
+        for (int i = 0; i < width; ++i)
+        {
+            const int tick = row + i;
+            if (tick < 1 || tick >= ticks || !simd::lane(any, i))
+            {
+                continue;
+            }
+            ret.kind = simd::lane(side, i) ? Contact::Side : (simd::lane(land, i) ? Contact::Land : Contact::Touch);
+            ret.tick = tick;
+            return ret;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,61 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _JUMP_ARC_H_
+#define _JUMP_ARC_H_
+
+#include <vector>
+#include "linal.h"
+#include "model/Rules.h"
+#include "BallTrajectory.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flight of a jumping bot, a row per tick up to the top of the jump, made once.
+// The bot leaves the ground in the first microtick of the tick it jumps on, so the flight starts
+// from its state after that tick (Simulator::robot_tick() with the jump). From there only gravity
+// acts on it: a row keeps how long it has flown by then and how far gravity has pulled it down,
+// the bot is the start plus its velocity times that time minus the drop, so one table serves all
+// the take-off states. Rows are padded to whole simd lanes.
+//
+class JumpArc
+{
+public:
+    JumpArc() {}
+    JumpArc(const model::Rules& rules, linal::real_t jump_speed);
+
+    // Rows 1 .. ticks() - 1 are the flight, row 1 is the tick of the jump
+    int ticks() const { return m_ticks; }
+
+    // Bot at the tick of the flight, from and vel are its state after the tick of the jump
+    linal::vec3 pos(int tick, const linal::vec3& from, const linal::vec3& vel) const
+    {
+        const linal::real_t run = m_run[tick];
+        return linal::vec3(from.x + vel.x * run, from.y + vel.y * run - m_drop[tick], from.z + vel.z * run);
+    }
+
+    struct Contact
+    {
+        enum Kinds {
+            None,               // none of the flight
+            Side,               // the ball is further than max_x off the middle, out of reach
+            Touch,              // the bot is under the ball and closer than reach to it
+            Land                // the bot is back down on the floor, the table knows no arena
+        } kind = None;
+        int tick = 0;
+    };
+
+    // First tick of the flight something happens, the ball taken from the trajectory at
+    // first_tick + the flight tick. Only looks as far as the ball is predicted, grow() it first.
+    // The bot lands once its center is under floor_y. The rows go a few simd lanes at a time.
+    Contact scan(const BallTrajectory& ball, int first_tick, const linal::vec3& from, const linal::vec3& vel
+        , linal::real_t reach, linal::real_t max_x, linal::real_t floor_y) const;
+
+private:
+    int m_ticks = 0;
+    std::vector<linal::real_t> m_drop;
+    std::vector<linal::real_t> m_run;
+};
+
+#endif // _JUMP_ARC_H_
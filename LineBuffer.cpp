@@ -0,0 +1,70 @@
+#include "LineBuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+LineBuffer::LineBuffer(size_t capacity) :
+    m_data(max(capacity, (size_t)1))
+{
+}
+
+char* LineBuffer::reserve(size_t bytes)
+{
+    if (m_data.size() - m_end < bytes)
+    {
+        // Only the tail of a line is left unread usually, it goes to the front
+        const size_t unread = m_end - m_begin;
+        memmove(m_data.data(), m_data.data() + m_begin, unread);
+        m_scanned -= m_begin;
+        m_begin = 0;
+        m_end = unread;
+        if (m_data.size() - m_end < bytes)
+        {
+            m_data.resize(max(m_data.size() * 2, m_end + bytes));
+        }
+    }
+    return m_data.data() + m_end;
+}
+
+void LineBuffer::commit(size_t bytes)
+{
+    m_end = min(m_end + bytes, m_data.size());
+}
+
+string_view LineBuffer::next_line()
+{
+    char* begin = m_data.data() + m_begin;
+    char* eol = (char*)memchr(m_data.data() + m_scanned, '\n', m_end - m_scanned);
+    if (!eol)
+    {
+        m_scanned = m_end;
+        return string_view();
+    }
+
+    *eol = '\0';
+    m_begin = m_scanned = (size_t)(eol - m_data.data()) + 1;
+    return string_view(begin, (size_t)(eol - begin));
+}
+
+string_view LineBuffer::next_frame()
+{
+    uint32_t size;
+    if (m_end - m_begin < sizeof(size))
+    {
+        return string_view();
+    }
+    memcpy(&size, m_data.data() + m_begin, sizeof(size));
+    if (m_end - m_begin - sizeof(size) < size)
+    {
+        return string_view();
+    }
+
+    const char* payload = m_data.data() + m_begin + sizeof(size);
+    m_begin += sizeof(size) + size;
+    m_scanned = max(m_scanned, m_begin);
+    return string_view(payload, size);
+}
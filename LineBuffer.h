@@ -0,0 +1,48 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _LINE_BUFFER_H_
+#define _LINE_BUFFER_H_
+
+#include <string_view>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Receive buffer of a line or frame based stream. Bytes go in right at its end (reserve() and commit()),
+// whole lines or frames come out as views into the buffer, nothing is copied on the way out.
+// The unread tail is moved to the front only when the room at the end runs out.
+//
+class LineBuffer
+{
+public:
+    explicit LineBuffer(size_t capacity = 64 * 1024);
+
+    // Room for at least the given bytes at the end, write them there and commit() as many as came.
+    // May move or grow the buffer, the lines handed out before are gone then.
+    char* reserve(size_t bytes);
+    void commit(size_t bytes);
+
+    // Next whole line without its '\n', the '\n' itself is overwritten by '\0', so the line
+    // is a C string that can be parsed in place (rapidjson ParseInsitu).
+    // A view with no data when the line has not arrived completely yet.
+    std::string_view next_line();
+
+    // Payload of the next whole frame, a uint32 little-endian size followed by that many bytes
+    // (see BinaryProtocol.h). A view with no data until all of it has arrived.
+    std::string_view next_frame();
+
+    // Writable bytes of a line handed out by next_line()
+    char* data(std::string_view line) { return m_data.data() + (line.data() - m_data.data()); }
+
+    size_t capacity() const { return m_data.size(); }
+
+private:
+    std::vector<char> m_data;
+    size_t m_begin = 0;                 // first byte not handed out yet
+    size_t m_scanned = 0;               // the bytes from m_begin up to it have no '\n'
+    size_t m_end = 0;                   // end of the received bytes
+};
+
+#endif // _LINE_BUFFER_H_
@@ -1,14 +1,24 @@
 #include "MyStrategy.h"
 #include <algorithm>
 #include "linal.h"
+#include "ArenaModel.h"
+#include "Simulator.h"
+#include "WorldState.h"
+#include "BallTrajectory.h"
+#include "JumpArc.h"
+#include "TimeBudget.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <mutex>
 using namespace linal;
 using namespace std;
 using namespace model;
 
 alignas(16) static Rules s_rules;
-static Arena& s_arena = s_rules.arena;
+static ArenaModel s_arena_model;
+static const real_t s_sim_tolerance = 1e-4_r;
 static bool s_nitro_game = false;
 static vec3 s_home_pos;
 static vec3 s_goal_pos;
@@ -16,6 +26,24 @@ static real_t s_max_jump_height;
 static real_t s_jump_time;
 static real_t s_acceleration_time;
 static real_t s_acceleration_distance;
+// Rules the planner uses, in real_t so that nothing in there is computed in double
+static real_t s_ball_radius;
+static real_t s_robot_radius;
+static real_t s_robot_min_radius;
+static real_t s_robot_max_radius;
+static real_t s_gravity;
+static real_t s_max_entity_speed;
+static real_t s_max_ground_speed;
+static real_t s_max_jump_speed;
+static real_t s_robot_acceleration;
+static real_t s_max_nitro;
+static real_t s_half_width;
+static real_t s_half_depth;
+static real_t s_goal_width;
+static real_t s_goal_side_radius;
+static real_t s_bottom_radius;
+static real_t s_home_r;
+static real_t s_k_ball;
 int MyStrategy::s_tick = -1;
 real_t s_timestep;
 real_t s_microstep;
@@ -64,1177 +92,882 @@ struct PerfCounter
 //////////////////////////////////////////////////////////////////////////
 //
 //
-struct alignas(16) Entity
-{
-    vec3 pos;
-    vec3 vel;
-    real_t nitro = 0.0_r;
-    real_t radius = 0.0_r;
-    real_t mass = 0.0_r;
-    real_t arena_e = 0.0_r;
-    vec3 normal;
-    bool touch = false;
-
-    static real_t s_entity_e;
-};
+WorldState s_state;
+static Simulator s_simulator;
 
-real_t Entity::s_entity_e = 0.0_r;
+//////////////////////////////////////////////////////////////////////////
+//
+//
+static int s_ball_horizon = 100;
+static const real_t s_ball_match = 0.001_r;
+static const real_t s_ball_rejoin = 0.01_r;
+static BallTrajectory s_ball_trajectory;
+static JumpArc s_jump_arc;
+static int s_current_tick = 0;
+//////////////////////////////////////////////////////////////////////////
+//
+//
+static TimeBudget s_budget;
+static double s_time_budget = 0.0;      // seconds for the match, 0 for s_tick_seconds a tick
+static const double s_tick_seconds = 0.02;
+static FILE* s_budget_log = nullptr;
 
-struct World
+//////////////////////////////////////////////////////////////////////////
+//
+//
+static int s_threads = 1;
+static unique_ptr<ThreadPool> s_pool;
+// The bots planned side by side share the ball prediction, it grows and is read under the lock then
+static mutex s_ball_lock;
+
+// World slot of every robot in the order the server sends them, set in init()
+static int s_robot_slots[World::max_bots];
+// Ticks the trajectory grows by between the looks at the clock, the blocks start at tick zero
+static const int s_grow_step = 16;
+
+// Takes s_ball_lock only when the pool has more than one thread
+unique_lock<mutex> LockBall()
 {
-    Entity ball;
-    map<int, Entity> bots;
-};
-
-World s_world;
+    unique_lock<mutex> guard(s_ball_lock, defer_lock);
+    if (s_pool->threads() > 1)
+    {
+        guard.lock();
+    }
+    return guard;
+}
 
-struct TouchInfo
+// Grows the prediction up to the tick or as far as the tick deadline lets it, true if it gets there.
+// Only whole blocks are grown: the bots planned side by side ask for their ticks in any order,
+// the segments come out the same. Call it under LockBall()
+bool GrowBall(int tick)
 {
-    vec3 normal;            // from object to arena or from first object to second
-    real_t depth = 0.0_r;   // penetration depth
-};
+    const int end = min(tick, s_ball_trajectory.horizon_tick());
+    for (int last = s_ball_trajectory.last_tick(); last < end; last = (last / s_grow_step + 1) * s_grow_step)
+    {
+        if (s_budget.expired())
+        {
+            s_budget.cut();
+            break;
+        }
+        s_ball_trajectory.grow((last / s_grow_step + 1) * s_grow_step);
+    }
+    return s_ball_trajectory.predicted(tick);
+}
 
-void move(Entity& e, real_t timestep)
+// Ball state the tick ahead, the prediction grows only as far as somebody asks.
+// False if it does not get there (the horizon or the tick deadline), the state is the last one predicted then
+bool GetBallTick(int tick, Entity& ball)
 {
-    e.vel.clamp((real_t)s_rules.MAX_ENTITY_SPEED);
-    e.pos += e.vel * timestep;
-    e.pos.y -= (real_t)s_rules.GRAVITY * timestep * timestep / 2.0_r;
-    e.vel.y -= (real_t)s_rules.GRAVITY * timestep;
+    auto guard = LockBall();
+    const bool predicted = GrowBall(s_current_tick + tick);
+    ball = s_ball_trajectory.at(s_current_tick + tick);
+    return predicted;
 }
 
 //////////////////////////////////////////////////////////////////////////
 //
 //
-static const size_t ballTicksCount = 100;
-static vector<Entity> s_ballTicks(ballTicksCount);
-static int s_current_tick = 0;
-Entity& GetBallTick(int tick)
+MyStrategy::MyStrategy()
 {
-    return s_ballTicks[(s_current_tick + ballTicksCount + tick) % ballTicksCount];
 }
 
-//////////////////////////////////////////////////////////////////////////
-//
-//
-TouchInfo CheckArenaCollision(const Entity& e)
+static void CloseBudgetLog()
 {
-    static vec3 simple_box(
-        (real_t)(s_arena.width - s_arena.top_radius)
-        , (real_t)(s_arena.height)
-        , real_t(s_arena.depth - s_arena.corner_radius)
-    );
-
-    TouchInfo ret;
-
-    if (abs(e.pos.z) <= simple_box.z)
+    s_budget.set_log(nullptr);
+    if (s_budget_log)
     {
-        if (abs(e.pos.x) <= simple_box.x)
-        {
-            ret.normal.y = e.pos.y - simple_box.y;
-            ret.depth = abs(ret.normal.y) + e.radius - simple_box.y;
-            ret.normal.y /= abs(ret.normal.y);
-            if (ret.depth > 0)
-            {
-                return ret;
-            }
-            ret.depth = 0.0_r;
-            return ret;
-        }
+        fclose(s_budget_log);
+        s_budget_log = nullptr;
+    }
+}
 
-        real_t size_y = s_arena.height - (s_arena.top_radius + s_arena.bottom_radius) / 2.0_r;
-        real_t pos_y = e.pos.y - (size_y + s_arena.bottom_radius);
-        if (abs(pos_y) <= size_y)
-        {
-            ret.depth = abs(e.pos.x) + e.radius - s_arena.width;
-            if (ret.depth > 0)
-            {
-                ret.normal.x = sign(e.pos.x);
-                return ret;
-            }
+MyStrategy::~MyStrategy()
+{
+    CloseBudgetLog();
+}
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
+void MyStrategy::set_ball_horizon(int ticks)
+{
+    s_ball_horizon = max(ticks, 2);
+    s_ball_trajectory.set_horizon(s_ball_horizon);
+}
 
-        if (pos_y > 0)
-        {
-            ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.top_radius)) * sign(e.pos.x);
-            ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
-            ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
-            if (ret.depth > 0)
-            {
-                ret.normal.normalize();
-                return ret;
-            }
+void MyStrategy::set_threads(int threads)
+{
+    s_threads = max(threads, 1);
+}
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
+void MyStrategy::set_time_budget(double seconds)
+{
+    s_time_budget = seconds;
+}
 
-        if (abs(e.pos.x) < (s_arena.width - s_arena.bottom_radius))
-        {
-            ret.depth = e.radius - e.pos.y;
-            if (ret.depth > 0)
-            {
-                ret.normal.y = -1.0_r;
-                return ret;
-            }
+void MyStrategy::set_budget_log(const char* path)
+{
+    CloseBudgetLog();
+    s_budget_log = fopen(path, "w");
+    s_budget.set_log(s_budget_log);
+}
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
+void MyStrategy::init(const model::Rules& rules, const Game& game)
+{
+    s_rules = rules;
+    s_arena_model = ArenaModel(rules.arena);
+    s_simulator = Simulator(rules, s_arena_model, s_sim_tolerance);
+    s_ball_trajectory = BallTrajectory(s_simulator, s_ball_horizon);
+    s_rules.arena.width /= 2.0;
+    s_rules.arena.height /= 2.0;
+    s_rules.arena.depth /= 2.0;
+    s_home_pos = vec3(0.0_r, 0.0_r, (-(real_t)s_rules.arena.depth) + (-(real_t)rules.arena.goal_width / 2.0_r));
+    s_goal_pos = vec3(0.0_r, 0.0_r, (((real_t)s_rules.arena.depth) + ((real_t)rules.arena.goal_depth)));
 
-        ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.bottom_radius)) * sign(e.pos.x);
-        ret.normal.y = e.pos.y - s_arena.bottom_radius;
-        ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
-        if (ret.depth > 0)
-        {
-            ret.normal.normalize();
-            return ret;
-        }
+    s_state = WorldState();
+    s_state.reset_delay = rules.RESET_TICKS;
+    s_state.world.ball.radius = (real_t)rules.BALL_RADIUS;
+    s_state.world.ball.mass = (real_t)rules.BALL_MASS;
+    s_state.world.ball.arena_e = (real_t)rules.BALL_ARENA_E;
+    s_timestep = 1.0_r / (real_t)rules.TICKS_PER_SECOND;
+    s_microstep = s_timestep / (real_t)rules.MICROTICKS_PER_TICK;
 
-        ret.depth = 0.0_r;
-        return ret;
+    s_ball_radius = (real_t)rules.BALL_RADIUS;
+    s_robot_radius = (real_t)rules.ROBOT_RADIUS;
+    s_robot_min_radius = (real_t)rules.ROBOT_MIN_RADIUS;
+    s_robot_max_radius = (real_t)rules.ROBOT_MAX_RADIUS;
+    s_gravity = (real_t)rules.GRAVITY;
+    s_max_entity_speed = (real_t)rules.MAX_ENTITY_SPEED;
+    s_max_ground_speed = (real_t)rules.ROBOT_MAX_GROUND_SPEED;
+    s_max_jump_speed = (real_t)rules.ROBOT_MAX_JUMP_SPEED;
+    s_robot_acceleration = (real_t)rules.ROBOT_ACCELERATION;
+    s_max_nitro = (real_t)rules.MAX_NITRO_AMOUNT;
+    s_half_width = (real_t)s_rules.arena.width;
+    s_half_depth = (real_t)s_rules.arena.depth;
+    s_goal_width = (real_t)rules.arena.goal_width;
+    s_goal_side_radius = (real_t)rules.arena.goal_side_radius;
+    s_bottom_radius = (real_t)rules.arena.bottom_radius;
+    s_home_r = (real_t)rules.arena.goal_width / 1.4_r;
+    s_k_ball = (real_t)rules.ROBOT_MASS / ((real_t)rules.BALL_MASS + (real_t)rules.ROBOT_MASS);
+
+    s_jump_time = s_max_jump_speed / s_gravity;
+    s_jump_arc = JumpArc(rules, s_max_jump_speed);
+    s_max_jump_height = s_max_jump_speed * s_max_jump_speed / s_gravity / 2.0_r;
+    s_acceleration_time = s_max_ground_speed / s_robot_acceleration;
+    s_acceleration_distance = s_max_ground_speed * s_max_ground_speed / s_robot_acceleration / 2.0_r;
+
+    s_budget.start_match((s_time_budget > 0.0) ? s_time_budget : s_tick_seconds * rules.max_tick_count, rules.max_tick_count);
+
+    // Slots in id order, teammates first
+    vector<const Robot*> robots;
+    for (const Robot& bot : game.robots)
+    {
+        robots.push_back(&bot);
     }
+    sort(robots.begin(), robots.end(), [](const Robot* a, const Robot* b)
+    {
+        return (a->is_teammate != b->is_teammate) ? a->is_teammate : (a->id < b->id);
+    });
 
-    if (abs(e.pos.x) >= (s_arena.width - s_arena.corner_radius))
+    real_t dist = 0.0_r;
+    int keeper = -1;
+    for (const Robot* robot : robots)
     {
-        real_t size_y = s_arena.height - (s_arena.top_radius + s_arena.bottom_radius) / 2.0_r;
-        real_t pos_y = e.pos.y - (size_y + s_arena.bottom_radius);
-        ret.normal.x = (abs(e.pos.x) - (s_arena.width - s_arena.corner_radius)) * sign(e.pos.x);
-        ret.normal.z = (abs(e.pos.z) - simple_box.z) * sign(e.pos.z);
-        ret.normal.y = ret.normal.len();
-        if (abs(pos_y) <= size_y)
+        const Robot& bot = *robot;
+        const int slot = s_state.world.add_bot(bot.id, bot.is_teammate);
+        if (slot < 0)
         {
-            ret.depth = ret.normal.y + e.radius - s_arena.corner_radius;
-            if (ret.depth > 0)
-            {
-                ret.normal.x /= ret.normal.y;
-                ret.normal.z /= ret.normal.y;
-                ret.normal.y = 0.0_r;
-                return ret;
-            }
-
-            ret.depth = 0.0_r;
-            return ret;
+            continue;
         }
-
-        if (pos_y > 0)
+        Entity& new_bot = s_state.world.bots[slot];
+        new_bot.arena_e = (real_t)rules.ROBOT_ARENA_E;
+        new_bot.mass = (real_t)rules.ROBOT_MASS;
+        if (!bot.is_teammate)
         {
-            if (ret.normal.y < (s_arena.corner_radius - s_arena.top_radius))
-            {
-                ret.depth = e.pos.y + e.radius - s_arena.height * 2.0_r;
-                if (ret.depth > 0)
-                {
-                    ret.normal = vec3(0.0_r, 1.0_r, 0.0_r);
-                    return ret;
-                }
-
-                ret.depth = 0.0_r;
-                return ret;
-            }
-
-            size_y = ret.normal.y;
-            ret.normal.y = 0.0_r;
-            ret.normal = ret.normal.normal() * (size_y - (s_arena.corner_radius - s_arena.top_radius));
-            ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
-            ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
-            if (ret.depth > 0)
-            {
-                ret.normal.normalize();
-                return ret;
-            }
-
-            ret.depth = 0.0_r;
-            return ret;
+            continue;
         }
-
-        if (ret.normal.y < (s_arena.corner_radius - s_arena.bottom_radius))
+        vec3 bot_pos((real_t)bot.x, (real_t)bot.y, (real_t)bot.z);
+        real_t center_dist = bot_pos.len();
+        if (center_dist > dist)
         {
-            ret.depth = e.radius - e.pos.y;
-            if (ret.depth > 0)
-            {
-                ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
-                return ret;
-            }
-
-            ret.depth = 0.0_r;
-            return ret;
+            dist = center_dist;
+            keeper = slot;
         }
-
-        size_y = ret.normal.y;
-        ret.normal.y = 0.0_r;
-        ret.normal = ret.normal.normal() * (size_y - (s_arena.corner_radius - s_arena.bottom_radius));
-        ret.normal.y = e.pos.y - s_arena.bottom_radius;
-        ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
-        if (ret.depth > 0)
+        if (bot.nitro_amount > 0)
         {
-            ret.normal.normalize();
-            return ret;
+            s_nitro_game = true;
         }
+    }
+    for (size_t i = 0; i < World::max_bots; ++i)
+    {
+        s_robot_slots[i] = (i < game.robots.size()) ? s_state.world.slot(game.robots[i].id) : -1;
+    }
+    m_bots.assign(s_state.world.teammates, MyBot());
+    if (keeper >= 0)
+    {
+        m_bots[keeper].role = MyBot::Keeper;
+    }
+    if (!s_pool || s_pool->threads() != s_threads)
+    {
+        s_pool.reset(new ThreadPool(s_threads));
+    }
+
+#ifdef MY_DEBUG
+    unsigned int currentControl;
+    _controlfp_s(&currentControl, ~(_EM_INVALID | _EM_ZERODIVIDE), _MCW_EM);
+#endif
 
-        ret.depth = 0.0_r;
-        return ret;
+    printf("v6.%llu\nbuilt %s\n", chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count(), __DATE__ " " __TIME__);
+}
+
+void MyStrategy::act(const Robot& me, const Rules& rules, const Game& game, Action& action)
+{
+    if (game.current_tick != s_tick && !plan(rules, game))
+    {
+        return;
     }
+    answer(me.id, action);
+}
 
-    if (e.pos.y >= (s_arena.goal_height + s_arena.goal_side_radius))
+void MyStrategy::act_team(const Rules& rules, const Game& game, unordered_map<int, Action>& actions)
+{
+    const bool planned = (game.current_tick == s_tick) || plan(rules, game);
+    for (const Robot& robot : game.robots)
     {
-        if (e.pos.y <= (s_arena.height * 2.0_r - s_arena.top_radius))
+        if (robot.is_teammate)
         {
-            ret.depth = abs(e.pos.z) + e.radius - s_arena.depth;
-            if (ret.depth > 0)
+            Action& action = actions[robot.id];
+            action = Action();
+            if (planned)
             {
-                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
-                return ret;
+                answer(robot.id, action);
             }
-
-            ret.depth = 0.0_r;
-            return ret;
         }
+    }
+}
 
-        if (abs(e.pos.z) <= (s_arena.depth - s_arena.top_radius))
+bool MyStrategy::plan(const Rules& rules, const Game& game)
+{
+    if (0 == game.current_tick)
+    {
+        init(rules, game);
+    }
+
+    s_current_tick = game.current_tick;
+    s_state.tick = game.current_tick;
+    for (const Player& player : game.players)
+    {
+        s_state.score[player.me ? 0 : 1] = player.score;
+    }
+    ++s_state.version;
+    s_ball_trajectory.reset_stats();
+    s_budget.start_tick(s_current_tick);
+
+    for (size_t i = 0; i < game.robots.size(); ++i)
+    {
+        const Robot& robot = game.robots[i];
+        // The robots come in the same order every tick, the slot is looked up only when they do not
+        int slot = (i < World::max_bots) ? s_robot_slots[i] : -1;
+        if (slot < 0 || s_state.world.ids[slot] != robot.id)
         {
-            ret.depth = e.pos.y + e.radius - s_arena.height * 2.0_r;
-            if (ret.depth > 0)
+            slot = s_state.world.slot(robot.id);
+            if (slot < 0)
             {
-                ret.normal = vec3(0.0_r, 1.0_r, 0.0_r);
-                return ret;
+                continue;
             }
-
-            ret.depth = 0.0_r;
-            return ret;
         }
+        Entity& body = s_state.world.bots[slot];
+        body.pos = vec3((real_t)robot.x, (real_t)robot.y, (real_t)robot.z);
+        body.vel = vec3((real_t)robot.velocity_x, (real_t)robot.velocity_y, (real_t)robot.velocity_z);
+        body.normal = vec3((real_t)robot.touch_normal_x, (real_t)robot.touch_normal_y, (real_t)robot.touch_normal_z);
+        body.touch = robot.touch;
+        body.nitro = (real_t)robot.nitro_amount;
+        body.radius = (real_t)robot.radius;
+    }
 
-        ret.normal.z = (abs(e.pos.z) - (s_arena.depth - s_arena.top_radius)) * sign(e.pos.z);
-        ret.normal.y = e.pos.y - (s_arena.height * 2.0_r - s_arena.top_radius);
-        ret.depth = ret.normal.len() + e.radius - s_arena.top_radius;
-        if (ret.depth > 0)
-        {
-            ret.normal.normalize();
-            return ret;
-        }
+    s_state.world.pack_count = min((int)game.nitro_packs.size(), World::max_packs);
+    for (int i = 0; i < s_state.world.pack_count; ++i)
+    {
+        s_state.world.packs[i].pos = vec3((real_t)game.nitro_packs[i].x, (real_t)game.nitro_packs[i].y, (real_t)game.nitro_packs[i].z);
+        s_state.world.packs[i].radius = (real_t)game.nitro_packs[i].radius;
+        s_state.world.packs[i].alive = game.nitro_packs[i].alive;
+        s_state.world.packs[i].respawn_ticks = game.nitro_packs[i].alive ? 0 : game.nitro_packs[i].respawn_ticks;
+    }
 
-        ret.depth = 0.0_r;
-        return ret;
+    s_state.world.ball.pos = vec3((real_t)game.ball.x, (real_t)game.ball.y, (real_t)game.ball.z);
+    s_state.world.ball.vel = vec3((real_t)game.ball.velocity_x, (real_t)game.ball.velocity_y, (real_t)game.ball.velocity_z);
+
+    if (abs(s_state.world.ball.pos.z) >= (s_half_depth + s_ball_radius))
+    {
+        s_budget.end_tick(0);
+        return false;
     }
 
-    if (abs(e.pos.z) < (s_arena.depth - s_arena.bottom_radius))
+    // Plans are made again only when the ball goes off the prediction by more than a small correction
+    s_ball_trajectory.forget(s_current_tick);
+    const bool recalc = (s_ball_trajectory.correct(s_state.world.ball, s_current_tick, s_ball_match, s_ball_rejoin) >= 0);
+
+    // Every bot writes only its own plan and grows the ball under the lock,
+    // so the bots may be planned side by side
+    auto plan_one = [&](int slot)
     {
-        ret.depth = e.radius - e.pos.y;
-        if (ret.depth > 0)
-        {
-            ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
-            return ret;
-        }
+        plan_bot(slot, m_bots[slot], game, recalc);
+    };
+    s_pool->run((int)m_bots.size(), plan_one);
+
+    s_budget.end_tick(s_ball_trajectory.last_tick() - s_current_tick);
+    s_tick = game.current_tick;
+    return true;
+}
+
+void MyStrategy::plan_bot(int slot, MyBot& bot, const Game& game, bool recalc)
+{
+    const Entity& bot_body = s_state.world.bots[slot];
+
 
-        ret.depth = 0.0_r;
-        return ret;
+    if (recalc)
+    {
+        bot.actions.clear();
+        bot.target_tick = 0;
+        ++bot.plan_version;
     }
 
-    if (abs(e.pos.x) >= (s_arena.goal_width / 2.0_r + s_arena.goal_side_radius))
+    if (MyBot::Forward == bot.role)
     {
-        if (e.pos.y > s_arena.bottom_radius)
+        if (recalc)
         {
-            ret.depth = abs(e.pos.z) + e.radius - s_arena.depth;
-            if (ret.depth > 0)
-            {
-                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
-                return ret;
-            }
-
-            ret.depth = 0.0_r;
-            return ret;
+            bot.target_tick = 0;
         }
 
-        ret.normal.y = e.pos.y - s_arena.bottom_radius;
-        ret.normal.z = (abs(e.pos.z) - (s_arena.depth - s_arena.bottom_radius)) * sign(e.pos.z);
-        ret.depth = e.radius + ret.normal.len() - s_arena.bottom_radius;
-        if (ret.depth > 0)
+        NextStep step;
+        step.pos = bot_body.pos;
+        step.vel = bot_body.vel;
+        step.nitro = bot_body.nitro;
+
+        vec3 next_pos = step.pos + step.vel * s_timestep;
+        Entity next_ball;
+        const bool next_predicted = GetBallTick(1, next_ball);
+        const vec3 ball_pos = next_ball.pos;
+        if (next_predicted
+            && (ball_pos.y >= (next_pos.y + s_robot_radius))
+            && (next_pos.z < ball_pos.z)
+            && (next_pos.dist(ball_pos) < (s_ball_radius + s_robot_radius)))
         {
-            ret.normal.normalize();
-            return ret;
+            step.jump_speed = s_max_jump_speed;
+            bot.target_tick = s_current_tick;
+            bot.target = next_pos;
+            bot.actions.push_front(step);
+            return;
         }
 
-        ret.depth = 0.0_r;
-        return ret;
-    }
-
-    if (abs(e.pos.z) <= (s_arena.depth + s_arena.goal_side_radius))
-    {
-        if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
+        if (!bot_body.touch)
         {
-            ret.depth = e.radius - e.pos.y;
-            if (ret.depth > 0)
+            if (s_current_tick > bot.target_tick)
             {
-                ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
-                return ret;
+                step.target_speed = vec3(0.0_r, -s_max_entity_speed, 0.0_r);
+                step.use_nitro = true;
             }
+            bot.actions.push_front(step);
+            return;
+        }
 
-            ret.normal.y = (s_arena.goal_height + s_arena.goal_side_radius) - e.pos.y;
-            ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius)- abs(e.pos.z)) * sign(e.pos.z);
-            ret.depth = (e.radius + s_arena.goal_side_radius) - ret.normal.len();
-            if (ret.depth > 0)
+        // On the ground the plan is made anew, the branches above only push onto the one there is
+        ++bot.plan_version;
+        const int tick_limit = s_ball_horizon - 1;
+        int catchTick = 1;
+        real_t target_time = catchTick * s_timestep;
+        BallTrajectory::Box reach_box;
+        reach_box.min.x = -(real_t)(s_half_width - s_bottom_radius);
+        reach_box.max.x = (real_t)(s_half_width - s_bottom_radius);
+        reach_box.max.y = s_max_jump_height + (real_t)s_ball_radius;
+        for (; catchTick < tick_limit; ++catchTick)
+        {
+            // Out of time nothing better than the fallback below is known
+            if (s_budget.expired())
             {
-                ret.normal.normalize();
-                return ret;
+                s_budget.cut();
+                catchTick = tick_limit;
+                break;
             }
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
+            Entity ball_target_state;
+            if (!GetBallTick(catchTick, ball_target_state))
+            {
+                catchTick = tick_limit;
+                break;
+            }
+            target_time = catchTick * s_timestep;
 
-        ret.normal.x = ((s_arena.goal_width / 2.0_r + s_arena.goal_side_radius) - abs(e.pos.x)) * sign(e.pos.x);
-        ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius) - abs(e.pos.z)) * sign(e.pos.z);
-        ret.depth = ret.normal.len();
-        if (e.pos.y < s_arena.bottom_radius)
-        {
-            if (ret.depth > (s_arena.bottom_radius + s_arena.goal_side_radius))
+            if (ball_target_state.pos.y > (s_max_jump_height + s_ball_radius)
+                || abs(ball_target_state.pos.x) > (s_half_width - s_bottom_radius))
             {
-                ret.depth = e.radius - e.pos.y;
-                if (ret.depth > 0)
+                // Straight to the tick the ball gets within reach
+                int entry;
                 {
-                    ret.normal = vec3(0.0_r, -1.0_r, 0.0_r);
-                    return ret;
+                    auto guard = LockBall();
+                    GrowBall(s_current_tick + tick_limit);
+                    entry = s_ball_trajectory.first_entry(reach_box, s_current_tick + catchTick);
                 }
-
-                ret.depth = 0.0_r;
-                return ret;
+                catchTick = (entry < 0) ? tick_limit : entry - s_current_tick - 1;
+                continue;
             }
 
-            ret.normal = -ret.normal.normal() * (s_arena.bottom_radius + s_arena.goal_side_radius);
-            ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r + s_arena.goal_side_radius + ret.normal.x * sign(e.pos.x))) * sign(e.pos.x);
-            ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_side_radius + ret.normal.z * sign(e.pos.z))) * sign(e.pos.z);
-            ret.normal.y = e.pos.y - s_arena.bottom_radius;
-            ret.depth = ret.normal.len() + e.radius - s_arena.bottom_radius;
-            if (ret.depth > 0)
+            vec3 ball_goal_dir = (s_goal_pos - ball_target_state.pos).normal();
+            vec3 ball_speed_dir = ball_target_state.vel.clamp(1.0);
+            ball_goal_dir = ball_goal_dir * 2.0_r - ball_speed_dir;
+            ball_goal_dir.y = min(ball_goal_dir.y, 0.0_r);
+            ball_goal_dir.normalize();
+            ball_goal_dir.x = -ball_goal_dir.x;
+            ball_goal_dir.z = -ball_goal_dir.z;
+
+            bot.target = (ball_target_state.pos + ball_goal_dir * (s_ball_radius + s_robot_radius - 0.1_r));
+            if (bot.target.y < s_robot_radius)
             {
-                ret.normal.normalize();
-                return ret;
+                real_t xz_target = sqrt((s_ball_radius + s_robot_radius) * (s_ball_radius + s_robot_radius) - s_robot_radius * s_robot_radius);
+                vec2 xz = ball_target_state.pos.xz() + ball_goal_dir.xz().normal() * xz_target;
+                bot.target = vec3(xz.x, s_robot_radius, xz.y);
             }
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
-
-        if (e.pos.y <= (s_arena.goal_height - s_arena.goal_top_radius))
-        {
-            ret.depth = e.radius + s_arena.goal_side_radius - ret.depth;
-            if (ret.depth > 0)
+            if (ball_target_state.pos.z < -(s_half_depth / 2.0_r)
+                && ball_target_state.vel.z < 0
+                && bot_body.pos.z > ball_target_state.pos.z)
             {
-                ret.normal.normalize();
-                return ret;
+                bot.target = ball_target_state.pos + vec3(-sqrt(3.0_r) / 2.0_r * sign(ball_target_state.pos.x), 0, -0.5_r) * (s_ball_radius + s_robot_radius - 0.1_r);
             }
-
-            ret.depth = 0.0_r;
-            return ret;
-        }
-
-        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
-        ret.normal.y = e.pos.y - (s_arena.goal_height - s_arena.goal_top_radius);
-        ret.normal.z = 0.0_r;
-        ret.normal = ret.normal.normal() * (s_arena.goal_top_radius + s_arena.goal_side_radius);
-         
-        ret.normal.x = ((s_arena.goal_width / 2.0_r - s_arena.goal_top_radius + ret.normal.x * sign(e.pos.x)) - abs(e.pos.x)) * sign(e.pos.x);
-        ret.normal.y = (s_arena.goal_height - s_arena.goal_top_radius + ret.normal.y) - e.pos.y;
-        ret.normal.z = ((s_arena.depth + s_arena.goal_side_radius) - abs(e.pos.z)) * sign(e.pos.z);
-        ret.depth = e.radius + s_arena.goal_side_radius - ret.normal.len();
-        if (ret.depth > 0)
-        {
-            ret.normal.normalize();
-            return ret;
-        }
-
-        ret.depth = 0.0_r;
-        return ret;
-    }
-
-    ret.normal.y = e.pos.y - s_arena.goal_height / 2.0_r;
-    
-    if (abs(e.pos.z) <= (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius))
-    {
-        if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
-        {
-            ret.depth = abs(ret.normal.y) + e.radius - s_arena.goal_height / 2.0_r;
-            if (ret.depth > 0)
+            
+            vec3 target_2d = bot.target;
+            target_2d.y = bot_body.pos.y;
+            if (bot_body.pos.dist(target_2d) > (s_max_ground_speed * target_time))
             {
-                ret.normal = vec3(0.0_r, sign(ret.normal.y), 0.0_r);
-                return ret;
+                continue;
             }
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
-
-        if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
-        {
-            ret.depth = abs(e.pos.x) + e.radius - s_arena.goal_width / 2.0_r;
-            if (ret.depth > 0)
+            if (ball_target_state.pos.z < -(s_half_depth / 2.0_r))
             {
-                ret.normal = vec3(sign(e.pos.x), 0.0_r, 0.0_r);
-                return ret;
-            }
+                vec3 guard_pos = vec3(0.0_r, 0.0_r, -s_half_depth - s_goal_side_radius);
+                real_t guard_r = s_goal_width * s_goal_width / (8.0_r * (s_goal_width / 2.0_r)) + (s_goal_width / 2.0_r) / 2.0_r;
 
-            ret.depth = 0.0_r;
-            return ret;
-        }
+                if (ball_target_state.pos.dist(guard_pos) <= guard_r
+                    || ball_target_state.pos.z < -(s_half_depth - s_bottom_radius))
+                {
+                    bot.target = vec3(0, 0, -s_half_depth / 2.0_r);
+                    for (auto& pack : game.nitro_packs)
+                    {
+                        vec3 pack_pos = vec3((real_t)pack.x, (real_t)pack.y, (real_t)pack.z);
+                        if (pack.alive && pack.z < 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(bot.target))
+                        {
+                            target_time = s_timestep;
+                            bot.target = pack_pos;
+                        }
+                    }
+                }
+            }
 
-        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
-        ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
-        ret.normal.z = 0.0_r;
-        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
-        if (ret.depth > 0)
-        {
-            ret.normal.normalize();
-            return ret;
+            break;
         }
 
-        ret.depth = 0.0_r;
-        return ret;
-    }
-
-    if (abs(e.pos.x) <= (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius))
-    {
-        if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
+        if (catchTick >= tick_limit)
         {
-            ret.depth = abs(e.pos.z) + e.radius - (s_arena.depth + s_arena.goal_depth);
-            if (ret.depth > 0)
+            target_time = s_timestep;
+            // Or the furthest the ball is predicted, if not as far
+            Entity ball;
+            GetBallTick(10, ball);
+            bot.target = ball.pos;
+            bot.target.z -= s_robot_radius;
+            if (bot.target.z < -(s_half_depth - s_bottom_radius))
             {
-                ret.normal = vec3(0.0_r, 0.0_r, sign(e.pos.z));
-                return ret;
+                bot.target = vec3(0, 0, -s_half_depth / 2.0_r);
+            }
+            for (auto& pack : game.nitro_packs)
+            {
+                vec3 pack_pos = vec3((real_t)pack.x, (real_t)pack.y, (real_t)pack.z);
+                if (pack.alive && pack.z > 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(bot.target))
+                {
+                    bot.target = pack_pos;
+                }
             }
-
-            ret.depth = 0.0_r;
-            return ret;
         }
 
-        ret.normal.x = 0.0_r;
-        ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
-        ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
-        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
-        if (ret.depth > 0)
+        vec3 target_dir_2d = bot.target - bot_body.pos;
+        target_dir_2d.y = 0.0_r;
+        vec3 target_speed = target_dir_2d / (target_time - s_timestep / 2.0_r);
+        if (target_speed.len() < s_max_ground_speed * 0.95_r)
         {
-            ret.normal.normalize();
-            return ret;
+            target_speed.z -= s_max_ground_speed;
         }
-        
-        ret.depth = 0.0_r;
-        return ret;
-    }
-
-    if (abs(ret.normal.y) <= (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius))
-    {
-        ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
-        ret.normal.y = 0.0_r;
-        ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
-        ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
-        if (ret.depth > 0)
+        step.target_speed = target_speed;
+        if (bot_body.nitro > 20.0_r && bot_body.vel.project(step.target_speed).len() < (s_max_ground_speed - 0.1_r))
         {
-            ret.normal.normalize();
-            return ret;
+            step.use_nitro = true;
         }
 
-        ret.depth = 0.0_r;
-        return ret;
-    }
-
-    ret.normal.x = (abs(e.pos.x) - (s_arena.goal_width / 2.0_r - s_arena.goal_top_radius)) * sign(e.pos.x);
-    ret.normal.y = (abs(ret.normal.y) - (s_arena.goal_height / 2.0_r - s_arena.goal_top_radius)) * sign(ret.normal.y);
-    ret.normal.z = (abs(e.pos.z) - (s_arena.depth + s_arena.goal_depth - s_arena.goal_top_radius)) * sign(e.pos.z);
-    ret.depth = ret.normal.len() + e.radius - s_arena.goal_top_radius;
-    if (ret.depth > 0)
-    {
-        ret.normal.normalize();
-        return ret;
-    }
-
-    ret.depth = 0.0_r;
-    return ret;
-}
-
-//////////////////////////////////////////////////////////////////////////
-//
-//
-Entity NextTick(const Entity& e)
-{
-    auto ret = e;
-    move(ret, s_timestep);
-
-    auto touch = CheckArenaCollision(ret);
-    if (touch.depth > 0)
-    {
-        ret = e;
-        for (int utick = 0; utick < s_rules.MICROTICKS_PER_TICK; ++utick)
         {
-            move(ret, s_microstep);
-
-            touch = CheckArenaCollision(ret);
-            if (touch.depth > 0)
+            // The tick of the jump: the bot runs along the ramp or the wall it is on for the first
+            // microtick and takes off along its normal, the flight out of the table from there on
+            Entity body = bot_body;
+            body.target_vel = step.target_speed;
+            body.jump_speed = s_max_jump_speed;
+            body.use_nitro = false;
+            s_simulator.robot_tick(body);
+
+            // The flight out of the table, the first tick the ball is out of reach or right over the bot decides
+            JumpArc::Contact contact;
+            Entity hit_ball;
+            {
+                auto guard = LockBall();
+                GrowBall(s_current_tick + s_jump_arc.ticks() - 1);
+                contact = s_jump_arc.scan(s_ball_trajectory, s_current_tick, body.pos, body.vel
+                    , s_ball_radius + s_robot_radius - 0.1_r, s_half_width - s_bottom_radius, s_robot_radius);
+                hit_ball = s_ball_trajectory.at(s_current_tick + contact.tick);
+            }
+            const vec3 hit_pos = s_jump_arc.pos(contact.tick, body.pos, body.vel);
+            if ((JumpArc::Contact::Touch == contact.kind) && ((hit_pos.z + 0.1_r) <= hit_ball.pos.z))
             {
-                ret.pos -= touch.normal * touch.depth;
-                real_t v = ret.vel.dot(touch.normal);
-                if (v > 0)
+                bot.actions.clear();
+                NextStep next = step;
+                next.vel = body.vel;
+                next.target_speed = next.vel;
+                for (int tick = 1; tick <= contact.tick; ++tick)
                 {
-                    ret.vel -= touch.normal * (1 + ret.arena_e) * v;
+                    next.pos = s_jump_arc.pos(tick, body.pos, body.vel);
+                    bot.actions.push_back(next);
                 }
+                step.jump_speed = s_max_jump_speed;
+                bot.target_tick = s_current_tick + contact.tick;
+                bot.target = hit_pos;
+            }
+            else
+            {
+                bot.actions.clear();
             }
         }
-    }
-
-    return std::move(ret);
-}
 
-Entity BallTick(const Entity& e)
-{
-    if (abs(e.pos.z) >= (s_arena.depth + s_rules.BALL_RADIUS))
-    {
-        return std::move(Entity(e));
+        bot.actions.push_front(step);
     }
 
-    return NextTick(e);
-}
-
-//////////////////////////////////////////////////////////////////////////
-//
-//
-void StepMove(MyStrategy::NextStep& step)
-{
-    vec3 dv = (step.target_speed - step.vel).clamp(s_rules.ROBOT_ACCELERATION * s_timestep);
-    if (dv.len() > s_rules.ROBOT_ACCELERATION * s_microstep)
+    else if (MyBot::Keeper == bot.role)
     {
-        for (int i = 0; i < s_rules.MICROTICKS_PER_TICK; ++i)
+        if (!bot.actions.empty())
         {
-            dv = (step.target_speed - step.vel).clamp(s_rules.ROBOT_ACCELERATION * s_microstep);
-            step.vel += dv;
-            step.vel.clamp(s_rules.ROBOT_MAX_GROUND_SPEED);
-            step.pos += step.vel * s_microstep;
+            if ((bot.actions.front().pos - bot_body.pos).len() < 0.00001_r
+                && (bot.actions.front().vel - bot_body.vel).len() < 0.00001_r)
+            {
+                return;
+            }
         }
-    }
-    else
-    {
-        step.vel += dv;
-        step.vel.clamp(s_rules.ROBOT_MAX_GROUND_SPEED);
-        step.pos += step.vel * s_timestep;
-    }
-}
-
-//////////////////////////////////////////////////////////////////////////
-//
-//
-MyStrategy::MyStrategy()
-{
-}
-
-void MyStrategy::init(const model::Rules& rules, const Game& game)
-{
-    s_rules = rules;
-    s_rules.arena.width /= 2.0;
-    s_rules.arena.height /= 2.0;
-    s_rules.arena.depth /= 2.0;
-    s_home_pos = vec3(0.0_r, 0.0_r, (-(real_t)s_rules.arena.depth) + (-(real_t)rules.arena.goal_width / 2.0_r));
-    s_goal_pos = vec3(0.0_r, 0.0_r, (((real_t)s_rules.arena.depth) + ((real_t)rules.arena.goal_depth)));
-    Entity::s_entity_e = (real_t)(rules.MAX_HIT_E - rules.MAX_HIT_E) / 2.0_r;
 
-    s_world.ball.radius = (real_t)rules.BALL_RADIUS;
-    s_world.ball.mass = (real_t)rules.BALL_MASS;
-    s_world.ball.arena_e = (real_t)rules.BALL_ARENA_E;
-    s_timestep = 1.0_r / (real_t)rules.TICKS_PER_SECOND;
-    s_microstep = s_timestep / (real_t)rules.MICROTICKS_PER_TICK;
+        bot.actions.push_back(NextStep());
+        auto& next = bot.actions.back();
 
-    s_jump_time = s_rules.ROBOT_MAX_JUMP_SPEED / s_rules.GRAVITY;
-    s_max_jump_height = s_rules.ROBOT_MAX_JUMP_SPEED * s_rules.ROBOT_MAX_JUMP_SPEED / s_rules.GRAVITY / 2.0_r;
-    s_acceleration_time = s_rules.ROBOT_MAX_GROUND_SPEED / s_rules.ROBOT_ACCELERATION;
-    s_acceleration_distance = s_rules.ROBOT_MAX_GROUND_SPEED * s_rules.ROBOT_MAX_GROUND_SPEED / s_rules.ROBOT_ACCELERATION / 2.0_r;
-
-    double dist = 0;
-    int keeper = -1;
-    for (auto& bot : game.robots)
-    {
-        Entity new_bot;
-        new_bot.arena_e = (real_t)rules.ROBOT_ARENA_E;
-        new_bot.mass = (real_t)rules.ROBOT_MASS;
-        s_world.bots.emplace(bot.id, new_bot);
-        if (!bot.is_teammate)
+        if (!bot_body.touch)
         {
-            continue;
-        }
-        m_bots.emplace(bot.id, MyBot());
-        vec3 bot_pos((real_t)bot.x, (real_t)bot.y, (real_t)bot.z);
-        double center_dist = bot_pos.len();
-        if (center_dist > dist)
-        {
-            dist = center_dist;
-            keeper = bot.id;
-        }
-        if (bot.nitro_amount > 0)
-        {
-            s_nitro_game = true;
-        }
-    }
-    m_bots[keeper].role = MyBot::Keeper;
-
-#ifdef MY_DEBUG
-    unsigned int currentControl;
-    _controlfp_s(&currentControl, ~(_EM_INVALID | _EM_ZERODIVIDE), _MCW_EM);
-#endif
+            vec3 next_pos = bot_body.pos + bot_body.vel * s_timestep;
 
-    printf("v6.%llu\nbuilt %s\n", chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count(), __DATE__ " " __TIME__);
-}
+            Entity next_ball;
+            if (GetBallTick(1, next_ball) && next_pos.dist(next_ball.pos) < (s_ball_radius + s_robot_radius))
+            {
+                next.jump_speed = s_max_jump_speed;
+            }
 
-void MyStrategy::act(const Robot& me, const Rules& rules, const Game& game, Action& action)
-{
-    static const real_t home_r = (real_t)rules.arena.goal_width / 1.4_r;
-    static const real_t k_ball = rules.ROBOT_MASS / (rules.BALL_MASS + rules.ROBOT_MASS);
+            if (bot.target_tick > s_current_tick && s_nitro_game)
+            {
+                next.target_speed = (bot.target - bot_body.pos) / ((bot.target_tick - s_current_tick) * s_timestep);
+                next.target_speed.y += s_gravity * s_timestep;
+                next.use_nitro = true;
+            }
 
-    if (game.current_tick != s_tick)
-    {
-        if (0 == game.current_tick)
-        {
-            init(rules, game);
+            return;
         }
 
-        s_current_tick = game.current_tick;
+        ++bot.plan_version;
+        vec3 guard_pos = vec3(0.0_r, 0.0_r, -s_half_depth - s_goal_side_radius);
+        real_t guard_r = s_goal_width * s_goal_width / (8.0_r * (s_goal_width / 2.0_r)) + (s_goal_width / 2.0_r) / 2.0_r;
 
-        for (size_t i = 0; i < game.robots.size(); ++i)
+        vec3 ball_dir = (s_state.world.ball.pos - s_home_pos);
+        ball_dir.y = 0.0_r;
+        ball_dir.normalize();
+        bot.target = s_home_pos + ball_dir * s_home_r;
+        if (abs(bot.target.x) >= (s_goal_width / 2.0_r - s_bottom_radius))
         {
-            s_world.bots[game.robots[i].id].pos = vec3((real_t)game.robots[i].x, (real_t)game.robots[i].y, (real_t)game.robots[i].z);
-            s_world.bots[game.robots[i].id].vel = vec3((real_t)game.robots[i].velocity_x, (real_t)game.robots[i].velocity_y, (real_t)game.robots[i].velocity_z);
-            s_world.bots[game.robots[i].id].normal = vec3(game.robots[i].touch_normal_x, game.robots[i].touch_normal_y, game.robots[i].touch_normal_z);
-            s_world.bots[game.robots[i].id].touch = game.robots[i].touch;
-            s_world.bots[game.robots[i].id].nitro = game.robots[i].nitro_amount;
+            bot.target.x = (s_goal_width / 2.0_r - s_bottom_radius) * sign(bot.target.x);
         }
+        vec3 target_dir = bot.target - bot_body.pos;
+        target_dir.y = 0.0_r;
+        real_t target_speed_d = 10.0_r * min(s_max_entity_speed, target_dir.len());
+        next.target_speed = target_dir.normal() * target_speed_d;
+        next.target_speed.y = 0.0_r;
+        next.jump_speed = 0.0_r;
+
+        if (s_state.world.ball.pos.z > 0)
+        {
+            if (s_nitro_game && bot_body.nitro < s_max_nitro)
+            {
+                vec3 target = vec3();
+                for (auto& pack : game.nitro_packs)
+                {
+                    vec3 pack_pos = vec3((real_t)pack.x, (real_t)pack.y, (real_t)pack.z);
+                    if (pack.alive && pack.z < 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(target))
+                    {
+                        target = pack_pos;
+                    }
+                }
 
-        s_world.ball.pos = vec3((real_t)game.ball.x, (real_t)game.ball.y, (real_t)game.ball.z);
-        s_world.ball.vel = vec3((real_t)game.ball.velocity_x, (real_t)game.ball.velocity_y, (real_t)game.ball.velocity_z);
+                if (target.z < 0)
+                {
+                    target.y = bot_body.pos.y;
+
+                    vec3 target_dir = target - bot_body.pos;
+                    next.target_speed = target_dir.normal() * s_max_ground_speed;
+                }
+            }
 
-        if (abs(s_world.ball.pos.z) >= (s_arena.depth + s_rules.BALL_RADIUS))
-        {
             return;
         }
 
-        bool recalc = true;
-
-        if (GetBallTick(0).pos.dist(s_world.ball.pos) > 0.001_r
-            || GetBallTick(0).vel.dist(s_world.ball.vel) > 0.001_r)
+        const int tick_limit = min(50, s_ball_horizon - 1);
+        int catchTick = 1;
+        Entity ball_target_state;
+        for (; catchTick < tick_limit; ++catchTick)
         {
-            GetBallTick(0) = s_world.ball;
-            for (int i = 1; i < ballTicksCount; ++i)
+            if (s_budget.expired())
+            {
+                s_budget.cut();
+                catchTick = tick_limit;
+                break;
+            }
+            if (!GetBallTick(catchTick, ball_target_state))
+            {
+                catchTick = tick_limit;
+                break;
+            }
+            if (ball_target_state.pos.dist(guard_pos) <= (guard_r + s_ball_radius) && ball_target_state.pos.y < (s_max_jump_height + s_ball_radius + s_robot_radius * 1.8_r))
             {
-                GetBallTick(i) = BallTick(GetBallTick(i - 1));
+                break;
             }
         }
-        else
+
+        if (catchTick == tick_limit)
         {
-            GetBallTick(0) = s_world.ball;
-            GetBallTick(-1) = BallTick(GetBallTick(-2));
-            recalc = false;
+            return;
         }
 
-        for (auto& item : m_bots)
+        real_t tick = (real_t)catchTick;
+
+        vec3 ball_vel = ball_target_state.vel;
+
+        bool force_move = false;
+        vec3 target_pos;
+        //   ,     
+        if (ball_target_state.pos.y <= (s_max_jump_height + s_robot_radius + (s_nitro_game ? s_ball_radius : 0.0_r)))
         {
-            auto& bot = item.second;
-            auto& bot_body = s_world.bots[item.first];
+            ball_vel.y = 0.0_r;
 
-            if (recalc)
-            {
-                bot.actions.clear();
-                bot.target_tick = 0;
-            }
+            vec3 safe_pos(s_goal_width / 2.0_r + s_ball_radius * 2.0_r, 0.0_r, -s_half_depth + s_ball_radius);
+            vec3 safe_dir_left = (safe_pos - ball_target_state.pos);
+            safe_dir_left.y = 0.0_r;
+            safe_dir_left.normalize();
+            safe_pos.x = -safe_pos.x;
+            vec3 safe_dir_right = (safe_pos - ball_target_state.pos);
+            safe_dir_right.y = 0.0_r;
+            safe_dir_right.normalize();
 
-            if (MyBot::Forward == bot.role)
-            {
-                if (recalc)
-                {
-                    bot.target_tick = 0;
-                }
+            real_t v_left = ball_vel.dot(safe_dir_left);
+            real_t v_right = ball_vel.dot(safe_dir_right);
 
-                NextStep step;
-                step.pos = bot_body.pos;
-                step.vel = bot_body.vel;
-                step.nitro = bot_body.nitro;
+            vec3 safe_dir = v_left > v_right ? safe_dir_left : safe_dir_right;
 
-                vec3 next_pos = step.pos + step.vel * s_timestep;
-                vec3 ball_pos = GetBallTick(1).pos;
-                if ((ball_pos.y >= (next_pos.y + s_rules.ROBOT_RADIUS))
-                    && (next_pos.z < ball_pos.z)
-                    && (next_pos.dist(ball_pos) < (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS)))
-                {
-                    step.jump_speed = s_rules.ROBOT_MAX_JUMP_SPEED;
-                    bot.target_tick = s_current_tick;
-                    bot.target = next_pos;
-                    bot.actions.push_front(step);
-                    continue;
-                }
+            vec3 speed_delta = ball_vel - ball_vel.project(safe_dir);
 
-                if (!bot_body.touch)
-                {
-                    if (s_current_tick > bot.target_tick)
-                    {
-                        step.target_speed = vec3(0.0_r, -s_rules.MAX_ENTITY_SPEED, 0.0_r);
-                        step.use_nitro = true;
-                    }
-                    bot.actions.push_front(step);
-                    continue;
-                }
+            vec3 impulse = speed_delta / s_k_ball;
 
-                const int tick_limit = ballTicksCount - 1;
-                int catchTick = 1;
-                real_t target_time = catchTick * s_timestep;
-                for (; catchTick < tick_limit; ++catchTick)
-                {
-                    auto ball_target_state = GetBallTick(catchTick);
-                    target_time = catchTick * s_timestep;
+            if (impulse.z > 0)
+            {
+                impulse.z = -impulse.z;
+            }
 
-                    if (ball_target_state.pos.y > (s_max_jump_height + s_rules.BALL_RADIUS)
-                        || abs(ball_target_state.pos.x) > (s_arena.width - s_arena.bottom_radius))
-                    {
-                        continue;
-                    }
+            target_pos = ball_target_state.pos + impulse.normal() * (s_ball_radius + s_robot_radius);
+            bot.target = target_pos;
+            addDebugSphere(DebugSphere({ target_pos.x, target_pos.y, target_pos.z }, 1.0_r, { 0.0_r, 1.0_r, 0.0_r }, 0.5_r));
 
-                    vec3 ball_goal_dir = (s_goal_pos - ball_target_state.pos).normal();
-                    vec3 ball_speed_dir = ball_target_state.vel.clamp(1.0);
-                    ball_goal_dir = ball_goal_dir * 2.0_r - ball_speed_dir;
-                    ball_goal_dir.y = min(ball_goal_dir.y, 0.0_r);
-                    ball_goal_dir.normalize();
-                    ball_goal_dir.x = -ball_goal_dir.x;
-                    ball_goal_dir.z = -ball_goal_dir.z;
+            vec3 target_dir_2d = target_pos - bot_body.pos;
+            real_t target_dist_y = target_dir_2d.y;
+            target_dir_2d.y = 0.0_r;
+            real_t target_dist_2d = target_dir_2d.len();
 
-                    bot.target = (ball_target_state.pos + ball_goal_dir * (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS - 0.1_r));
-                    if (bot.target.y < s_rules.ROBOT_RADIUS)
-                    {
-                        real_t xz_target = sqrt((s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS) * (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS) - s_rules.ROBOT_RADIUS * s_rules.ROBOT_RADIUS);
-                        vec2 xz = ball_target_state.pos.xz() + ball_goal_dir.xz().normal() * xz_target;
-                        bot.target = vec3(xz.x, s_rules.ROBOT_RADIUS, xz.y);
-                    }
+            real_t closing_vel = bot_body.vel.dot(target_dir_2d.normal());
 
-                    if (ball_target_state.pos.z < -(s_arena.depth / 2.0_r)
-                        && ball_target_state.vel.z < 0
-                        && bot_body.pos.z > ball_target_state.pos.z)
-                    {
-                        bot.target = ball_target_state.pos + vec3(-sqrt(3.0_r) / 2.0_r * sign(ball_target_state.pos.x), 0, -0.5_r) * (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS - 0.1_r);
-                    }
-                    
-                    vec3 target_2d = bot.target;
-                    target_2d.y = bot_body.pos.y;
-                    if (bot_body.pos.dist(target_2d) > (s_rules.ROBOT_MAX_GROUND_SPEED * target_time))
-                    {
-                        continue;
-                    }
+            real_t b = -2.0_r * s_max_jump_speed / s_gravity;
+            real_t c = 2.0_r * target_dist_y / s_gravity;
+            real_t d = b * b - 4.0_r * c;
 
-                    if (ball_target_state.pos.z < -(s_arena.depth / 2.0_r))
-                    {
-                        vec3 guard_pos = vec3(0.0_r, 0.0_r, -s_arena.depth - s_arena.goal_side_radius);
-                        real_t guard_r = s_arena.goal_width * s_arena.goal_width / (8.0_r * (s_arena.goal_width / 2.0_r)) + (s_arena.goal_width / 2.0_r) / 2.0_r;
+            real_t air_time;
+            if (d > 0)
+            {
+                air_time = ((-b - sqrt(d)) / 2.0_r);
+            }
+            else
+            {
+                air_time = s_jump_time;
+            }
 
-                        if (ball_target_state.pos.dist(guard_pos) <= guard_r
-                            || ball_target_state.pos.z < -(s_arena.depth - s_arena.bottom_radius))
-                        {
-                            bot.target = vec3(0, 0, -s_arena.depth / 2.0_r);
-                            for (auto& pack : game.nitro_packs)
-                            {
-                                vec3 pack_pos = vec3(pack.x, pack.y, pack.z);
-                                if (pack.alive && pack.z < 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(bot.target))
-                                {
-                                    target_time = s_timestep;
-                                    bot.target = pack_pos;
-                                }
-                            }
-                        }
-                    }
+            real_t acceleration_time = (s_max_ground_speed - closing_vel) / s_robot_acceleration;
+            real_t acceleration_dist = closing_vel * acceleration_time + s_robot_acceleration * acceleration_time * acceleration_time / 2.0_r;
 
-                    break;
-                }
+            b = 2.0_r * closing_vel / s_robot_acceleration;
+            c = -2.0_r * target_dist_2d / s_robot_acceleration;
+            d = b * b - 4.0_r * c;
+            if (d > 0)
+            {
+                real_t move_time = ((-b - sqrt(d)) / 2.0_r) / s_timestep;
 
-                if (catchTick >= tick_limit)
+                if (move_time / s_timestep > tick)
                 {
-                    target_time = s_timestep;
-                    bot.target = GetBallTick(10).pos;
-                    bot.target.z -= s_rules.ROBOT_RADIUS;
-                    if (bot.target.z < -(s_arena.depth - s_arena.bottom_radius))
-                    {
-                        bot.target = vec3(0, 0, -s_arena.depth / 2.0_r);
-                    }
-                    for (auto& pack : game.nitro_packs)
+                    vec3 ball_dir = (ball_target_state.pos - s_home_pos);
+                    ball_dir.y = 0.0_r;
+                    ball_dir.normalize();
+                    bot.target = s_home_pos + ball_dir * s_home_r;
+                    if (abs(bot.target.x) >= (s_goal_width / 2.0_r - s_bottom_radius))
                     {
-                        vec3 pack_pos = vec3(pack.x, pack.y, pack.z);
-                        if (pack.alive && pack.z > 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(bot.target))
-                        {
-                            bot.target = pack_pos;
-                        }
+                        bot.target.x = (s_goal_width / 2.0_r - s_bottom_radius) * sign(bot.target.x);
                     }
+                    vec3 target_dir = bot.target - bot_body.pos;
+                    target_dir.y = 0.0_r;
+                    real_t target_speed_d = 10.0_r * min(s_max_entity_speed, target_dir.len());
+                    next.target_speed = target_dir.normal() * target_speed_d;
+                    return;
                 }
 
-                vec3 target_dir_2d = bot.target - bot_body.pos;
-                target_dir_2d.y = 0.0_r;
-                vec3 target_speed = target_dir_2d / (target_time - s_timestep / 2.0_r);
-                if (target_speed.len() < s_rules.ROBOT_MAX_GROUND_SPEED * 0.95_r)
+                if ((acceleration_time - air_time) / s_timestep >= tick)
                 {
-                    target_speed.z -= s_rules.ROBOT_MAX_GROUND_SPEED;
+                    next.target_speed = s_max_entity_speed * 2.0_r * target_dir_2d.normal();
                 }
-                step.target_speed = target_speed;
-                if (bot_body.nitro > 20.0_r && bot_body.vel.project(step.target_speed).len() < (s_rules.ROBOT_MAX_GROUND_SPEED - 0.1_r))
+                else
                 {
-                    step.use_nitro = true;
+                    next.target_speed = target_dist_2d / (tick * s_timestep) * target_dir_2d.normal();
                 }
-
-                {
-                    NextStep next = step;
-                    vec3 dv = (next.target_speed - step.vel).clamp(s_rules.ROBOT_ACCELERATION * s_microstep);
-                    next.vel += dv;
-                    next.vel.clamp(s_rules.ROBOT_MAX_GROUND_SPEED);
-                    next.pos += next.vel * s_timestep;
-                    next.target_speed = next.vel;
-                    const int air_ticks = (int)floor(s_jump_time / s_timestep);
-                    real_t air_time = 0.0_r;
-                    int tick = 1;
-                    for (; tick < air_ticks; ++tick, StepMove(next))
-                    {
-                        air_time += s_timestep;
-                        next.pos.y = s_rules.ROBOT_RADIUS + (s_rules.ROBOT_MAX_RADIUS - s_rules.ROBOT_MIN_RADIUS) + s_rules.ROBOT_MAX_JUMP_SPEED * air_time; 
-                        next.pos.y -= s_rules.GRAVITY * air_time * air_time / 2.0_r;
-                        bot.actions.push_back(next);
-                        vec3 ball_pos = GetBallTick(tick).pos;
-                        if (abs(ball_pos.x) > (s_arena.width - s_arena.bottom_radius))
-                        {
-                            bot.actions.clear();
-                            break;
-                        }
-                        if (ball_pos.y < next.pos.y)
-                        {
-                            continue;
-                        }
-                        if ((next.pos.dist(ball_pos) < (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS - 0.1_r)))
-                        {
-                            if ((next.pos.z + 0.1_r) > ball_pos.z)
-                            {
-                                bot.actions.clear();
-                                break;
-                            }
-                            step.jump_speed = s_rules.ROBOT_MAX_JUMP_SPEED;
-                            bot.target_tick = s_current_tick + tick;
-                            bot.target = next.pos;
-                            break;
-                        }
-                    }
-
-                    if (tick >= air_ticks)
-                    {
-                        bot.actions.clear();
-                    }
-                }
-
-                bot.actions.push_front(step);
             }
-
-            else if (MyBot::Keeper == bot.role)
+            else
             {
-                if (!bot.actions.empty())
-                {
-                    if ((bot.actions.front().pos - bot_body.pos).len() < 0.00001_r
-                        && (bot.actions.front().vel - bot_body.vel).len() < 0.00001_r)
-                    {
-                        continue;
-                    }
-                }
-
-                bot.actions.push_back(NextStep());
-                auto& next = bot.actions.back();
-
-                if (!bot_body.touch)
-                {
-                    vec3 next_pos = bot_body.pos + bot_body.vel * s_timestep;
-
-                    if (next_pos.dist(GetBallTick(1).pos) < (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS))
-                    {
-                        next.jump_speed = s_rules.ROBOT_MAX_JUMP_SPEED;
-                    }
-
-                    if (bot.target_tick > s_current_tick && s_nitro_game)
-                    {
-                        next.target_speed = (bot.target - bot_body.pos) / ((bot.target_tick - s_current_tick) * s_timestep);
-                        next.target_speed.y += s_rules.GRAVITY * s_timestep;
-                        next.use_nitro = true;
-                    }
-
-                    continue;
-                }
-
-                vec3 guard_pos = vec3(0.0_r, 0.0_r, -s_arena.depth - s_arena.goal_side_radius);
-                real_t guard_r = s_arena.goal_width * s_arena.goal_width / (8.0_r * (s_arena.goal_width / 2.0_r)) + (s_arena.goal_width / 2.0_r) / 2.0_r;
-
-                vec3 ball_dir = (s_world.ball.pos - s_home_pos);
+                vec3 ball_dir = (ball_target_state.pos - s_home_pos);
                 ball_dir.y = 0.0_r;
                 ball_dir.normalize();
-                bot.target = s_home_pos + ball_dir * home_r;
-                if (abs(bot.target.x) >= (s_arena.goal_width / 2.0_r - s_arena.bottom_radius))
+                bot.target = s_home_pos + ball_dir * s_home_r;
+                if (abs(bot.target.x) >= (s_goal_width / 2.0_r - s_bottom_radius))
                 {
-                    bot.target.x = (s_arena.goal_width / 2.0_r - s_arena.bottom_radius) * sign(bot.target.x);
+                    bot.target.x = (s_goal_width / 2.0_r - s_bottom_radius) * sign(bot.target.x);
                 }
                 vec3 target_dir = bot.target - bot_body.pos;
                 target_dir.y = 0.0_r;
-                double target_speed_d = 10.0_r * min(s_rules.MAX_ENTITY_SPEED, target_dir.len());
+                real_t target_speed_d = 10.0_r * min(s_max_entity_speed, target_dir.len());
                 next.target_speed = target_dir.normal() * target_speed_d;
-                next.target_speed.y = 0.0_r;
-                next.jump_speed = 0.0_r;
-
-                if (s_world.ball.pos.z > 0)
-                {
-                    if (s_nitro_game && bot_body.nitro < s_rules.MAX_NITRO_AMOUNT)
-                    {
-                        vec3 target = vec3();
-                        for (auto& pack : game.nitro_packs)
-                        {
-                            vec3 pack_pos = vec3(pack.x, pack.y, pack.z);
-                            if (pack.alive && pack.z < 0 && bot_body.pos.dist(pack_pos) < bot_body.pos.dist(target))
-                            {
-                                target = pack_pos;
-                            }
-                        }
+                return;
+            }
 
-                        if (target.z < 0)
-                        {
-                            target.y = bot_body.pos.y;
+            if (tick <= air_time / s_timestep && bot_body.touch)
+            {
+                next.jump_speed = s_max_jump_speed;
+                bot.target_tick = s_current_tick + catchTick;
+            }
+        }
+        //    
+        else
+        {
+            guard_pos = vec3(0.0_r, 0.0_r, -s_half_depth - s_goal_side_radius - s_ball_radius);
+            vec3 ball_dir = guard_pos - ball_target_state.pos;
+            ball_dir.normalize();
+            target_pos = ball_target_state.pos + ball_dir * (s_ball_radius + s_robot_radius);
 
-                            vec3 target_dir = target - bot_body.pos;
-                            next.target_speed = target_dir.normal() * s_rules.ROBOT_MAX_GROUND_SPEED;
-                        }
-                    }
+            bot.target = target_pos;
+            addDebugSphere(DebugSphere({ target_pos.x, target_pos.y, target_pos.z }, 1.0_r, { 0.0_r, 0.0_r, 1.0_r }, 0.5_r));
 
-                    continue;
-                }
+            vec3 target_dir_2d = target_pos - bot_body.pos;
+            real_t target_dist_y = target_dir_2d.y;
+            target_dir_2d.y = 0.0_r;
+            real_t target_dist_2d = target_dir_2d.len();
 
-                const int tick_limit = (int)min((size_t)50, ballTicksCount - 1);
-                int catchTick = 1;
-                auto ball_target_state = GetBallTick(catchTick);
-                for (; catchTick < tick_limit; ++catchTick)
-                {
-                    ball_target_state = GetBallTick(catchTick);
-                    if (ball_target_state.pos.dist(guard_pos) <= (guard_r + s_rules.BALL_RADIUS) && ball_target_state.pos.y < (s_max_jump_height + s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS * 1.8_r))
-                    {
-                        break;
-                    }
-                }
+            real_t b = -2.0_r * s_max_jump_speed / s_gravity;
+            real_t c = 2.0_r * target_dist_y / s_gravity;
+            real_t d = b * b - 4.0_r * c;
 
-                if (catchTick == tick_limit)
-                {
-                    continue;
-                }
+            real_t target_time;
+            if (d > 0)
+            {
+                target_time = ((-b - sqrt(d)) / 2.0_r);
+            }
+            else
+            {
+                target_time = s_jump_time;
+            }
 
-                real_t tick = (real_t)catchTick;
+            real_t closing_vel = bot_body.vel.dot(target_dir_2d.normal());
 
-                vec3 ball_vel = ball_target_state.vel;
+            if (closing_vel * target_time > target_dist_2d)
+            {
+                next.target_speed = vec3();
+            }
+            else
+            {
+                real_t acceleration_time = (s_max_ground_speed - closing_vel) / s_robot_acceleration;
+                real_t acceleration_dist = closing_vel * acceleration_time + s_robot_acceleration * acceleration_time * acceleration_time / 2.0_r;
 
-                bool force_move = false;
-                vec3 target_pos;
-                //   ,     
-                if (ball_target_state.pos.y <= (s_max_jump_height + s_rules.ROBOT_RADIUS + (s_nitro_game ? s_rules.BALL_RADIUS : 0.0_r)))
+                real_t b = 2.0_r * closing_vel / s_robot_acceleration;
+                real_t c = -2.0_r * target_dist_2d / s_robot_acceleration;
+                real_t d = b * b - 4.0_r * c;
+                if (d > 0)
                 {
-                    ball_vel.y = 0.0_r;
-
-                    vec3 safe_pos(s_arena.goal_width / 2.0_r + s_rules.BALL_RADIUS * 2.0_r, 0.0_r, -s_arena.depth + s_rules.BALL_RADIUS);
-                    vec3 safe_dir_left = (safe_pos - ball_target_state.pos);
-                    safe_dir_left.y = 0.0_r;
-                    safe_dir_left.normalize();
-                    safe_pos.x = -safe_pos.x;
-                    vec3 safe_dir_right = (safe_pos - ball_target_state.pos);
-                    safe_dir_right.y = 0.0_r;
-                    safe_dir_right.normalize();
+                    next.target_speed = target_dist_2d / target_time * target_dir_2d.normal();
 
-                    real_t v_left = ball_vel.dot(safe_dir_left);
-                    real_t v_right = ball_vel.dot(safe_dir_right);
+                    real_t move_time = ((-b - sqrt(d)) / 2.0_r) / s_timestep;
 
-                    vec3 safe_dir = v_left > v_right ? safe_dir_left : safe_dir_right;
-
-                    vec3 speed_delta = ball_vel - ball_vel.project(safe_dir);
-
-                    vec3 impulse = speed_delta / k_ball;
-
-                    if (impulse.z > 0)
-                    {
-                        impulse.z = -impulse.z;
-                    }
-
-                    target_pos = ball_target_state.pos + impulse.normal() * (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS);
-                    bot.target = target_pos;
-                    addDebugSphere(DebugSphere({ target_pos.x, target_pos.y, target_pos.z }, 1.0_r, { 0.0_r, 1.0_r, 0.0_r }, 0.5_r));
-
-                    vec3 target_dir_2d = target_pos - bot_body.pos;
-                    real_t target_dist_y = target_dir_2d.y;
-                    target_dir_2d.y = 0.0_r;
-                    real_t target_dist_2d = target_dir_2d.len();
-
-                    real_t closing_vel = bot_body.vel.dot(target_dir_2d.normal());
-
-                    real_t b = -2.0_r * s_rules.ROBOT_MAX_JUMP_SPEED / s_rules.GRAVITY;
-                    real_t c = 2.0_r * target_dist_y / s_rules.GRAVITY;
-                    real_t d = b * b - 4.0_r * c;
-
-                    real_t air_time;
-                    if (d > 0)
-                    {
-                        air_time = ((-b - sqrt(d)) / 2.0_r);
-                    }
-                    else
-                    {
-                        air_time = s_jump_time;
-                    }
-
-                    real_t acceleration_time = (s_rules.ROBOT_MAX_GROUND_SPEED - closing_vel) / s_rules.ROBOT_ACCELERATION;
-                    real_t acceleration_dist = closing_vel * acceleration_time + s_rules.ROBOT_ACCELERATION * acceleration_time * acceleration_time / 2.0_r;
-
-                    b = 2.0_r * closing_vel / s_rules.ROBOT_ACCELERATION;
-                    c = -2.0_r * target_dist_2d / s_rules.ROBOT_ACCELERATION;
-                    d = b * b - 4.0_r * c;
-                    if (d > 0)
-                    {
-                        real_t move_time = ((-b - sqrt(d)) / 2.0_r) / s_timestep;
-
-                        if (move_time / s_timestep > tick)
-                        {
-                            vec3 ball_dir = (ball_target_state.pos - s_home_pos);
-                            ball_dir.y = 0.0_r;
-                            ball_dir.normalize();
-                            bot.target = s_home_pos + ball_dir * home_r;
-                            if (abs(bot.target.x) >= (s_arena.goal_width / 2.0_r - s_arena.bottom_radius))
-                            {
-                                bot.target.x = (s_arena.goal_width / 2.0_r - s_arena.bottom_radius) * sign(bot.target.x);
-                            }
-                            vec3 target_dir = bot.target - bot_body.pos;
-                            target_dir.y = 0.0_r;
-                            double target_speed_d = 10.0_r * min(s_rules.MAX_ENTITY_SPEED, target_dir.len());
-                            next.target_speed = target_dir.normal() * target_speed_d;
-                            continue;
-                        }
-
-                        if ((acceleration_time - air_time) / s_timestep >= tick)
-                        {
-                            next.target_speed = s_rules.MAX_ENTITY_SPEED * 2.0_r * target_dir_2d.normal();
-                        }
-                        else
-                        {
-                            next.target_speed = target_dist_2d / (tick * s_timestep) * target_dir_2d.normal();
-                        }
-                    }
-                    else
+                    if (move_time > target_time)
                     {
                         vec3 ball_dir = (ball_target_state.pos - s_home_pos);
                         ball_dir.y = 0.0_r;
                         ball_dir.normalize();
-                        bot.target = s_home_pos + ball_dir * home_r;
-                        if (abs(bot.target.x) >= (s_arena.goal_width / 2.0_r - s_arena.bottom_radius))
+                        bot.target = s_home_pos + ball_dir * s_home_r;
+                        if (abs(bot.target.x) >= (s_goal_width / 2.0_r - s_bottom_radius))
                         {
-                            bot.target.x = (s_arena.goal_width / 2.0_r - s_arena.bottom_radius) * sign(bot.target.x);
+                            bot.target.x = (s_goal_width / 2.0_r - s_bottom_radius) * sign(bot.target.x);
                         }
                         vec3 target_dir = bot.target - bot_body.pos;
                         target_dir.y = 0.0_r;
-                        double target_speed_d = 10.0_r * min(s_rules.MAX_ENTITY_SPEED, target_dir.len());
+                        real_t target_speed_d = 10.0_r * min(s_max_entity_speed, target_dir.len());
                         next.target_speed = target_dir.normal() * target_speed_d;
-                        continue;
-                    }
-
-                    if (tick <= air_time / s_timestep && bot_body.touch)
-                    {
-                        next.jump_speed = s_rules.ROBOT_MAX_JUMP_SPEED;
-                        bot.target_tick = s_current_tick + catchTick;
+                        return;
                     }
                 }
-                //    
                 else
                 {
-                    guard_pos = vec3(0.0_r, 0.0_r, -s_arena.depth - s_arena.goal_side_radius - s_rules.BALL_RADIUS);
-                    vec3 ball_dir = guard_pos - ball_target_state.pos;
+                    vec3 ball_dir = (ball_target_state.pos - s_home_pos);
+                    ball_dir.y = 0.0_r;
                     ball_dir.normalize();
-                    target_pos = ball_target_state.pos + ball_dir * (s_rules.BALL_RADIUS + s_rules.ROBOT_RADIUS);
-
-                    bot.target = target_pos;
-                    addDebugSphere(DebugSphere({ target_pos.x, target_pos.y, target_pos.z }, 1.0_r, { 0.0_r, 0.0_r, 1.0_r }, 0.5_r));
-
-                    vec3 target_dir_2d = target_pos - bot_body.pos;
-                    real_t target_dist_y = target_dir_2d.y;
-                    target_dir_2d.y = 0.0_r;
-                    real_t target_dist_2d = target_dir_2d.len();
-
-                    real_t b = -2.0_r * s_rules.ROBOT_MAX_JUMP_SPEED / s_rules.GRAVITY;
-                    real_t c = 2.0_r * target_dist_y / s_rules.GRAVITY;
-                    real_t d = b * b - 4.0_r * c;
-
-                    real_t target_time;
-                    if (d > 0)
-                    {
-                        target_time = ((-b - sqrt(d)) / 2.0_r);
-                    }
-                    else
-                    {
-                        target_time = s_jump_time;
-                    }
-
-                    real_t closing_vel = bot_body.vel.dot(target_dir_2d.normal());
-
-                    if (closing_vel * target_time > target_dist_2d)
-                    {
-                        next.target_speed = vec3();
-                    }
-                    else
+                    bot.target = s_home_pos + ball_dir * s_home_r;
+                    if (abs(bot.target.x) >= (s_goal_width / 2.0_r - s_bottom_radius))
                     {
-                        real_t acceleration_time = (s_rules.ROBOT_MAX_GROUND_SPEED - closing_vel) / s_rules.ROBOT_ACCELERATION;
-                        real_t acceleration_dist = closing_vel * acceleration_time + s_rules.ROBOT_ACCELERATION * acceleration_time * acceleration_time / 2.0_r;
-
-                        real_t b = 2.0_r * closing_vel / s_rules.ROBOT_ACCELERATION;
-                        real_t c = -2.0_r * target_dist_2d / s_rules.ROBOT_ACCELERATION;
-                        real_t d = b * b - 4.0_r * c;
-                        if (d > 0)
-                        {
-                            next.target_speed = target_dist_2d / target_time * target_dir_2d.normal();
-
-                            real_t move_time = ((-b - sqrt(d)) / 2.0_r) / s_timestep;
-
-                            if (move_time > target_time)
-                            {
-                                vec3 ball_dir = (ball_target_state.pos - s_home_pos);
-                                ball_dir.y = 0.0_r;
-                                ball_dir.normalize();
-                                bot.target = s_home_pos + ball_dir * home_r;
-                                if (abs(bot.target.x) >= (s_arena.goal_width / 2.0_r - s_arena.bottom_radius))
-                                {
-                                    bot.target.x = (s_arena.goal_width / 2.0_r - s_arena.bottom_radius) * sign(bot.target.x);
-                                }
-                                vec3 target_dir = bot.target - bot_body.pos;
-                                target_dir.y = 0.0_r;
-                                double target_speed_d = 10.0_r * min(s_rules.MAX_ENTITY_SPEED, target_dir.len());
-                                next.target_speed = target_dir.normal() * target_speed_d;
-                                continue;
-                            }
-                        }
-                        else
-                        {
-                            vec3 ball_dir = (ball_target_state.pos - s_home_pos);
-                            ball_dir.y = 0.0_r;
-                            ball_dir.normalize();
-                            bot.target = s_home_pos + ball_dir * home_r;
-                            if (abs(bot.target.x) >= (s_arena.goal_width / 2.0_r - s_arena.bottom_radius))
-                            {
-                                bot.target.x = (s_arena.goal_width / 2.0_r - s_arena.bottom_radius) * sign(bot.target.x);
-                            }
-                            vec3 target_dir = bot.target - bot_body.pos;
-                            target_dir.y = 0.0_r;
-                            double target_speed_d = 10.0_r * min(s_rules.MAX_ENTITY_SPEED, target_dir.len());
-                            next.target_speed = target_dir.normal() * target_speed_d;
-                            continue;
-                        }
-                    }
-
-                    if (tick <= target_time / s_timestep && bot_body.touch)
-                    {
-                        next.jump_speed = s_rules.ROBOT_MAX_JUMP_SPEED;
-                        bot.target_tick = s_current_tick + catchTick;
+                        bot.target.x = (s_goal_width / 2.0_r - s_bottom_radius) * sign(bot.target.x);
                     }
+                    vec3 target_dir = bot.target - bot_body.pos;
+                    target_dir.y = 0.0_r;
+                    real_t target_speed_d = 10.0_r * min(s_max_entity_speed, target_dir.len());
+                    next.target_speed = target_dir.normal() * target_speed_d;
+                    return;
                 }
             }
-        }
 
-        s_tick = game.current_tick;
+            if (tick <= target_time / s_timestep && bot_body.touch)
+            {
+                next.jump_speed = s_max_jump_speed;
+                bot.target_tick = s_current_tick + catchTick;
+            }
+        }
     }
+}
 
-    MyBot& me_bot = m_bots[me.id];
+void MyStrategy::answer(int id, Action& action)
+{
+    const int slot = s_state.world.slot(id);
+    if (slot < 0 || slot >= (int)m_bots.size())
+    {
+        return;
+    }
+    MyBot& me_bot = m_bots[slot];
 
     if (!me_bot.actions.empty())
     {
@@ -1255,9 +988,26 @@ void MyStrategy::act(const Robot& me, const Rules& rules, const Game& game, Acti
     }
 }
 
+unsigned MyStrategy::plan_version() const
+{
+    unsigned version = 0;
+    for (const MyBot& bot : m_bots)
+    {
+        version += bot.plan_version;
+    }
+    return version;
+}
+
+const MyStrategy::MyBot* MyStrategy::find_bot(int id) const
+{
+    const int slot = s_state.world.slot(id);
+    return (slot >= 0 && slot < (int)m_bots.size()) ? &m_bots[slot] : nullptr;
+}
+
 void MyStrategy::addDebugSphere(DebugSphere&& sphere)
 {
 #ifdef MY_DEBUG
+    lock_guard<mutex> lock(m_debugMutex);
     m_debugSpheres.push_back(sphere);
 #else
     (sphere);
@@ -1300,9 +1050,34 @@ std::string MyStrategy::custom_rendering()
         str += buffer.data();
     }
 
-    //addDebugSphere(DebugSphere({ s_world.ball.pos.x, s_world.ball.pos.y, s_world.ball.pos.z }, s_rules.BALL_RADIUS, { 1.0_r, 1.0_r, 1.0_r }, 0.3_r));
-    for (auto& ball : s_ballTicks)
+    //addDebugSphere(DebugSphere({ s_state.world.ball.pos.x, s_state.world.ball.pos.y, s_state.world.ball.pos.z }, s_ball_radius, { 1.0_r, 1.0_r, 1.0_r }, 0.3_r));
+    const BallTrajectory::Stats& ball_stats = s_ball_trajectory.stats();
+    const BallTrajectory::Stats& ball_totals = s_ball_trajectory.totals();
+    sprintf_s(buffer.data(), buffer.size(), R"___(  {
+    "Text": "ball: %d of %d ticks predicted this tick, %d stepped, %d segments"
+  },
+  {
+    "Text": "ball so far: %d ticks predicted, %d stepped, %d reused, %d anchored, %d missed, %d resets"
+  },
+)___"
+, ball_stats.predicted
+, s_ball_trajectory.last_tick() - s_current_tick + 1
+, ball_stats.stepped
+, (int)s_ball_trajectory.segments().size()
+, ball_totals.predicted + ball_stats.predicted
+, ball_totals.stepped + ball_stats.stepped
+, ball_totals.reused + ball_stats.reused
+, ball_totals.anchored + ball_stats.anchored
+, ball_totals.missed + ball_stats.missed
+, ball_totals.resets + ball_stats.resets
+);
+
+    str += buffer.data();
+
+    // Only what the planners asked for, drawing does not grow the prediction
+    for (int tick = s_current_tick; tick <= s_ball_trajectory.last_tick(); ++tick)
     {
+        const Entity ball = s_ball_trajectory.at(tick);
         sprintf_s(buffer.data(), buffer.size(), R"___(  {
     "Sphere": {
       "x": %lf,
@@ -1319,7 +1094,7 @@ std::string MyStrategy::custom_rendering()
 , (double)ball.pos.x
 , (double)ball.pos.y
 , (double)ball.pos.z
-, (double)s_rules.BALL_RADIUS
+, (double)s_ball_radius
 );
 
         str += buffer.data();
@@ -1327,8 +1102,9 @@ std::string MyStrategy::custom_rendering()
 
     for (auto& bot : m_bots)
     {
-        for (auto& step : bot.second.actions)
+        for (int i = 0; i < bot.actions.size(); ++i)
         {
+            const NextStep& step = bot.actions[i];
             sprintf_s(buffer.data(), buffer.size(), R"___(  {
     "Sphere": {
       "x": %lf,
@@ -1345,7 +1121,7 @@ std::string MyStrategy::custom_rendering()
 , (double)step.pos.x
 , (double)step.pos.y
 , (double)step.pos.z
-, (double)s_rules.ROBOT_RADIUS
+, (double)s_robot_radius
 );
 
             str += buffer.data();
@@ -6,20 +6,38 @@
 #define _MY_STRATEGY_H_
 
 #include "Strategy.h"
-#include <map>
 #include <list>
-#include <queue>
+#include <vector>
+#ifdef MY_DEBUG
+#include <mutex>
+#endif
 #include "linal.h"
+#include "RingBuffer.h"
 using linal::operator""_r;
 
 class MyStrategy : public Strategy {
 public:
     MyStrategy();
+    ~MyStrategy();
 
     void act(const model::Robot& me, const model::Rules& rules, const model::Game& world, model::Action& action) override;
+    // One planning pass for the whole team, act() is the same for a single robot
+    void act_team(const model::Rules& rules, const model::Game& game, std::unordered_map<int, model::Action>& actions) override;
 
     void init(const model::Rules& rules, const model::Game& game);
 
+    // How many ticks ahead the ball may be predicted, the planners look no further
+    static void set_ball_horizon(int ticks);
+
+    // Threads the bots are planned on, the calling one included. Takes effect at the next init().
+    static void set_threads(int threads);
+
+    // Seconds the planners may spend over the match (a share of it is kept in reserve), 0 for the default
+    static void set_time_budget(double seconds);
+    // A line per tick of how the budget went, see TimeBudget::set_log(). The file is closed
+    // with the strategy or when another one is set.
+    static void set_budget_log(const char* path);
+
 public:
     struct NextStep {
         linal::vec3 pos;
@@ -38,16 +56,27 @@ public:
         } role = Forward;
         linal::vec3 target;
         int target_tick = 0;
-        std::deque<NextStep> actions;
+        // A full jump is JUMP_SPEED / GRAVITY = 30 ticks in the air with the game rules
+        static const int max_steps = 64;
+        RingBuffer<NextStep, max_steps> actions;
+        unsigned plan_version = 0;          // goes up whenever the plan is made anew
     };
 
-    size_t m_ready = 0;
-
-    void ComputeForward(MyBot& bot, int id);
+    // Plans of all the bots for a new tick, false while the ball is in a goal (nothing to do then)
+    bool plan(const model::Rules& rules, const model::Game& game);
+    // Plan of one bot, reads the shared state only, safe to run side by side with the others
+    void plan_bot(int slot, MyBot& bot, const model::Game& game, bool recalc);
+    // Next step of the bot's plan into its action
+    void answer(int id, model::Action& action);
 
 public:
     static int s_tick;
 
+    // Sum of the plan versions of the bots, the same as before a tick when every plan was kept
+    unsigned plan_version() const override;
+    // Plan of the teammate, nullptr for any other robot
+    const MyBot* find_bot(int id) const;
+
 private:
     struct DebugSphere {
         linal::vec3 center;
@@ -63,12 +92,13 @@ private:
 
 #ifdef MY_DEBUG
     std::list<DebugSphere> m_debugSpheres;
+    std::mutex m_debugMutex;
 
     std::string custom_rendering() override;
 #endif
 
 private:
-    std::map<int, MyBot> m_bots;
+    std::vector<MyBot> m_bots;                          // by World slot of the teammate
 };
 
 #endif // _MY_STRATEGY_H_
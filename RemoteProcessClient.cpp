@@ -1,45 +1,77 @@
 #include <iostream>
-#include "rapidjson/document.h"
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
+#include <cstring>
+#include <chrono>
 
 #include "RemoteProcessClient.h"
+#include "JsonDecoder.h"
+#include "BinaryProtocol.h"
 
 using namespace std;
 using namespace model;
-using namespace rapidjson;
 
 const int32 BUFFER_SIZE = 8 * 1024;
 
-string RemoteProcessClient::readline() {
+// Adds the time since the mark to the phase and moves the mark, when times are being counted
+static void count_time(RemoteProcessClient::Times* times, double RemoteProcessClient::Times::* phase, chrono::steady_clock::time_point& mark) {
+    if (times) {
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        times->*phase += (double)chrono::duration_cast<chrono::nanoseconds>(now - mark).count();
+        mark = now;
+    }
+}
+
+// Appends what the socket has to the buffer, received right there, false at the end of the stream
+bool RemoteProcessClient::receive() {
+    int32 received = socket.ReceiveInto(reinterpret_cast<uint8*>(buffer.reserve(BUFFER_SIZE)), BUFFER_SIZE);
+    if (received < 0) {
+        cerr << "Error reading from socket" << endl;
+        exit(10002);
+    }
+    if (received == 0) {
+        return false;
+    }
+    buffer.commit(received);
+    return true;
+}
+
+// The line stays in the buffer until the next readline(), it is parsed right there
+string_view RemoteProcessClient::readline() {
     while (true) {
-        size_t eol = buffer.find('\n');
-        if (eol != string::npos) {
-            string line = buffer.substr(0, eol);
-            buffer = buffer.substr(eol + 1);
+        string_view line = buffer.next_line();
+        if (line.data() != nullptr) {
             return line;
         }
-        int32 received = socket.Receive(BUFFER_SIZE);
-        if (received < 0) {
-            cerr << "Error reading from socket" << endl;
-            exit(10002);
+        if (!receive()) {
+            return string_view();
         }
-        if (received == 0) {
-            return "";
+    }
+}
+
+string_view RemoteProcessClient::readframe() {
+    while (true) {
+        string_view payload = buffer.next_frame();
+        if (payload.data() != nullptr) {
+            return payload;
+        }
+        if (!receive()) {
+            return string_view();
         }
-        buffer.append(socket.GetData(), socket.GetData() + received);
     }
 }
 
 void RemoteProcessClient::writeline(string line) {
     line.push_back('\n');
-    if (socket.Send(reinterpret_cast<const uint8*>(line.c_str()), static_cast<int32_t>(line.length())) < 0) {
+    send(line);
+}
+
+void RemoteProcessClient::send(string_view data) {
+    if (socket.Send(reinterpret_cast<const uint8*>(data.data()), static_cast<int32_t>(data.length())) < 0) {
         cerr << "Failed to send data" << endl;
         exit(10003);
     }
 }
 
-RemoteProcessClient::RemoteProcessClient(string host, int port) {
+RemoteProcessClient::RemoteProcessClient(string host, int port, bool binary) : binary(binary) {
     socket.Initialize();
     socket.DisableNagleAlgoritm();
 
@@ -48,44 +80,51 @@ RemoteProcessClient::RemoteProcessClient(string host, int port) {
         exit(10001);
     }
 
-    writeline("json");
+    writeline(binary ? "binary" : "json");
 }
 
 unique_ptr<Rules> RemoteProcessClient::read_rules() {
-    string line = readline();
+    string_view line = binary ? readframe() : readline();
     if (line.empty()) {
         return unique_ptr<Rules>();
     }
-    Document d;
-    d.Parse(line.c_str());
     unique_ptr<Rules> result(new Rules());
-    result->read(d);
+    if (binary ? !BinaryProtocol::read(line, *result) : !JsonDecoder::read(buffer.data(line), *result)) {
+        cerr << "Failed to read rules" << endl;
+        exit(10004);
+    }
     return result;
 }
 
-unique_ptr<Game> RemoteProcessClient::read_game() {
-    string line = readline();
+// The game is filled over, its vectors keep their memory from tick to tick
+bool RemoteProcessClient::read_game(Game& game) {
+    chrono::steady_clock::time_point mark = times ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
+    string_view line = binary ? readframe() : readline();
+    count_time(times, &Times::io, mark);
     if (line.empty()) {
-        return unique_ptr<Game>();
+        return false;
     }
-    Document d;
-    d.Parse(line.c_str());
-    unique_ptr<Game> result(new Game());
-    result->read(d);
-    return result;
+    if (binary ? !BinaryProtocol::read(line, game) : !JsonDecoder::read(buffer.data(line), game)) {
+        cerr << "Failed to read game" << endl;
+        exit(10004);
+    }
+    count_time(times, &Times::parse, mark);
+    return true;
 }
 
 void RemoteProcessClient::write(const unordered_map<int, Action>& actions, const string& custom_rendering) {
-    Document d;
-    d.SetObject();
-    Document::AllocatorType& allocator = d.GetAllocator();
-    for (auto it : actions) {
-        d.AddMember(Value(to_string(it.first).c_str(), allocator).Move(), it.second.to_json(allocator).Move(), allocator);
+    chrono::steady_clock::time_point mark = times ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
+    string_view answer;
+    if (binary) {
+        frame.clear();
+        BinaryProtocol::write(actions, custom_rendering, frame);
+        answer = string_view(frame.data(), frame.size());
+    } else {
+        answer = encoder.encode(actions, custom_rendering);
     }
-    StringBuffer buffer;
-    Writer<StringBuffer> writer(buffer);
-    d.Accept(writer);
-    writeline(string(buffer.GetString()) + "|" + custom_rendering + "\n<end>");
+    count_time(times, &Times::serialize, mark);
+    send(answer);
+    count_time(times, &Times::io, mark);
 }
 
 void RemoteProcessClient::write_token(const string& token) {
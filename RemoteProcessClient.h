@@ -8,24 +8,45 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "csimplesocket/ActiveSocket.h"
+#include "LineBuffer.h"
+#include "ActionEncoder.h"
 
 #include "model/Action.h"
 #include "model/Game.h"
 #include "model/Rules.h"
 
 class RemoteProcessClient {
+public:
+    // Nanoseconds spent per phase, summed over the calls, counted once set_times() is given them
+    struct Times {
+        double io = 0.0;            // waiting for the server and in send/receive
+        double parse = 0.0;         // decoding the game
+        double serialize = 0.0;     // encoding the answer
+    };
+private:
     CActiveSocket socket;
-    std::string buffer;
-    std::string readline();
+    LineBuffer buffer;
+    ActionEncoder encoder;
+    bool binary;
+    std::vector<char> frame;
+    Times* times = nullptr;
+    bool receive();
+    std::string_view readline();
+    std::string_view readframe();
     void writeline(std::string line);
+    void send(std::string_view data);
 public:
-    RemoteProcessClient(std::string host, int port);
+    // Binary mode is understood by the stand-in server only, see BinaryProtocol.h
+    RemoteProcessClient(std::string host, int port, bool binary = false);
     std::unique_ptr<model::Rules> read_rules();
-    std::unique_ptr<model::Game> read_game();
+    bool read_game(model::Game& game);
     void write(const std::unordered_map<int, model::Action>& actions, const std::string& custom_rendering);
     void write_token(const std::string& token);
+    void set_times(Times* times) { this->times = times; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include <cassert>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Double ended queue of at most N items kept inline, nothing is allocated. Pushing to a full
+// buffer drops an item: push_back() the one pushed, push_front() the one at the back.
+// N is a power of two, the positions wrap with a mask.
+//
+template <typename T, int N>
+class RingBuffer
+{
+    static_assert(N > 0 && 0 == (N & (N - 1)), "RingBuffer capacity is a power of two");
+
+public:
+    bool empty() const { return 0 == m_size; }
+    bool full() const { return N == m_size; }
+    int size() const { return m_size; }
+    static int capacity() { return N; }
+
+    void clear() { m_size = 0; }
+
+    T& operator[](int i) { assert(i < m_size); return m_items[(m_first + i) & (N - 1)]; }
+    const T& operator[](int i) const { assert(i < m_size); return m_items[(m_first + i) & (N - 1)]; }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[m_size - 1]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    // False when full and the item is dropped
+    bool push_back(const T& item)
+    {
+        if (full())
+        {
+            return false;
+        }
+        m_items[(m_first + m_size) & (N - 1)] = item;
+        ++m_size;
+        return true;
+    }
+
+    void push_front(const T& item)
+    {
+        m_first = (m_first - 1) & (N - 1);
+        m_items[m_first] = item;
+        if (m_size < N)
+        {
+            ++m_size;
+        }
+    }
+
+    void pop_front()
+    {
+        assert(m_size > 0);
+        m_first = (m_first + 1) & (N - 1);
+        --m_size;
+    }
+
+    void pop_back()
+    {
+        assert(m_size > 0);
+        --m_size;
+    }
+
+private:
+    T m_items[N];
+    int m_first = 0;
+    int m_size = 0;
+};
+
+#endif // _RING_BUFFER_H_
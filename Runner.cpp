@@ -1,14 +1,84 @@
 #include <memory>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
 
 #include "Runner.h"
 #include "MyStrategy.h"
+#include "Benchmark.h"
+#include "StandInServer.h"
 
 using namespace model;
 using namespace std;
 
+// Value of a name=value option, false with a message when it is not a number from min on
+static bool read_option(const char* arg, double min, double& value) {
+    const char* text = strchr(arg, '=') + 1;
+    char* end = nullptr;
+    errno = 0;
+    value = strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !(value >= min)) {
+        fprintf(stderr, "bad option %s, expected a number from %g on\n", arg, min);
+        return false;
+    }
+    return true;
+}
+
+static bool read_option(const char* arg, int min, int& value) {
+    const char* text = strchr(arg, '=') + 1;
+    char* end = nullptr;
+    errno = 0;
+    const long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > INT_MAX) {
+        fprintf(stderr, "bad option %s, expected a whole number from %d on\n", arg, min);
+        return false;
+    }
+    value = (int)parsed;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc == 4) {
-        Runner runner(argv[1], argv[2], argv[3]);
+#ifdef MY_BENCHMARK
+    if (argc >= 2 && 0 == strcmp(argv[1], "bench")) {
+        return RunBenchmarks(argc - 2, argv + 2);
+    }
+    if (argc >= 3 && 0 == strcmp(argv[1], "serve")) {
+        return RunStandInServer(atoi(argv[2]), argc >= 4 ? argv[3] : nullptr);
+    }
+#endif
+    if (argc >= 4) {
+        bool binary = false;
+        for (int i = 4; i < argc; ++i) {
+            binary = binary || 0 == strcmp(argv[i], "binary");
+            if (0 == strncmp(argv[i], "horizon=", 8)) {
+                int ticks = 0;
+                if (!read_option(argv[i], 2, ticks)) {
+                    return 1;
+                }
+                MyStrategy::set_ball_horizon(ticks);
+            }
+            if (0 == strncmp(argv[i], "budget=", 7)) {
+                double seconds = 0.0;
+                if (!read_option(argv[i], 0.0, seconds)) {
+                    return 1;
+                }
+                MyStrategy::set_time_budget(seconds);
+            }
+            if (0 == strncmp(argv[i], "budget_log=", 11)) {
+                MyStrategy::set_budget_log(argv[i] + 11);
+            }
+            if (0 == strncmp(argv[i], "threads=", 8)) {
+                int threads = 0;
+                if (!read_option(argv[i], 1, threads)) {
+                    return 1;
+                }
+                MyStrategy::set_threads(threads);
+            }
+        }
+        Runner runner(argv[1], argv[2], argv[3], binary);
         runner.run();
     } else {
         Runner runner("127.0.0.1", "31001", "0000000000000000");
@@ -18,23 +88,34 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
-Runner::Runner(const char* host, const char* port, const char* token)
-    : remoteProcessClient(host, atoi(port)), token(token) {
+static double elapsed_ns(chrono::steady_clock::time_point& mark) {
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    const double ns = (double)chrono::duration_cast<chrono::nanoseconds>(now - mark).count();
+    mark = now;
+    return ns;
+}
+
+Runner::Runner(const char* host, const char* port, const char* token, bool binary)
+    : remoteProcessClient(host, atoi(port), binary), token(token) {
+    remoteProcessClient.set_times(&times.client);
 }
 
 void Runner::run() {
     unique_ptr<Strategy> strategy(new MyStrategy);
-    unique_ptr<Game> game;
+    Game game;
     unordered_map<int, Action> actions;
     remoteProcessClient.write_token(token);
     unique_ptr<Rules> rules = remoteProcessClient.read_rules();
-    while ((game = remoteProcessClient.read_game()) != nullptr) {
-        actions.clear();
-        for (const Robot& robot : game->robots) {
-            if (robot.is_teammate) {
-                strategy->act(robot, *rules, *game, actions[robot.id]);
-            }
-        }
-        remoteProcessClient.write(actions, strategy->custom_rendering());
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (remoteProcessClient.read_game(game)) {
+        chrono::steady_clock::time_point mark = chrono::steady_clock::now();
+        const unsigned version = strategy->plan_version();
+        strategy->act_team(*rules, game, actions);
+        const string custom_rendering = strategy->custom_rendering();
+        times.think += elapsed_ns(mark);
+        ++times.ticks;
+        times.replans += (strategy->plan_version() != version) ? 1 : 0;
+        remoteProcessClient.write(actions, custom_rendering);
     }
+    times.wall = elapsed_ns(start);
 }
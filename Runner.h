@@ -10,13 +10,24 @@
 #include "RemoteProcessClient.h"
 
 class Runner {
+public:
+    // Nanoseconds per phase summed over the match
+    struct Times {
+        RemoteProcessClient::Times client;
+        double think = 0.0;
+        double wall = 0.0;          // from the rules received to the end of the match
+        int ticks = 0;
+        int replans = 0;            // ticks the strategy made a new plan on, see Strategy::plan_version()
+    };
 private:
     RemoteProcessClient remoteProcessClient;
     std::string token;
+    Times times;
 public:
-    Runner(const char*, const char*, const char*);
+    Runner(const char*, const char*, const char*, bool binary = false);
 
     void run();
+    const Times& get_times() const { return times; }
 };
 
 #endif
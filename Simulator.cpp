@@ -0,0 +1,444 @@
+#include "Simulator.h"
+#include <algorithm>
+using namespace linal;
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+Simulator::Simulator(const model::Rules& rules, const ArenaModel& arena, real_t tolerance) :
+    m_arena(&arena),
+    m_microticks(rules.MICROTICKS_PER_TICK),
+    m_timestep(1.0_r / (real_t)rules.TICKS_PER_SECOND),
+    m_microstep(1.0_r / (real_t)rules.TICKS_PER_SECOND / (real_t)rules.MICROTICKS_PER_TICK),
+    m_tolerance(tolerance),
+    m_gravity((real_t)rules.GRAVITY),
+    m_arena_height((real_t)rules.arena.height),
+    m_max_entity_speed((real_t)rules.MAX_ENTITY_SPEED),
+    m_hit_e((real_t)(rules.MIN_HIT_E + rules.MAX_HIT_E) / 2.0_r),
+    m_goal_line((real_t)(rules.arena.depth / 2.0 + rules.BALL_RADIUS)),
+    m_robot_min_radius((real_t)rules.ROBOT_MIN_RADIUS),
+    m_robot_max_radius((real_t)rules.ROBOT_MAX_RADIUS),
+    m_robot_max_jump_speed((real_t)rules.ROBOT_MAX_JUMP_SPEED),
+    m_robot_acceleration((real_t)rules.ROBOT_ACCELERATION),
+    m_robot_max_ground_speed((real_t)rules.ROBOT_MAX_GROUND_SPEED),
+    m_nitro_acceleration((real_t)rules.ROBOT_NITRO_ACCELERATION),
+    m_nitro_point_velocity_change((real_t)rules.NITRO_POINT_VELOCITY_CHANGE),
+    m_max_nitro((real_t)rules.MAX_NITRO_AMOUNT),
+    m_nitro_respawn_ticks(rules.NITRO_PACK_RESPAWN_TICKS)
+{
+}
+
+void Simulator::move(Entity& e, real_t dt) const
+{
+    e.vel.clamp(m_max_entity_speed);
+    e.pos += e.vel * dt;
+    e.pos.y -= m_gravity * dt * dt / 2.0_r;
+    e.vel.y -= m_gravity * dt;
+}
+
+// Returns true and the normal into the field when the entity bounced off the arena.
+bool Simulator::collide_arena(Entity& e, vec3& normal) const
+{
+    const TouchInfo touch = m_arena->collide(e.pos, e.radius);
+    if (touch.depth <= 0)
+    {
+        return false;
+    }
+
+    e.pos -= touch.normal * touch.depth;
+    const real_t v = e.vel.dot(touch.normal) + e.radius_change_speed;
+    if (v <= 0)
+    {
+        return false;
+    }
+
+    e.vel -= touch.normal * ((1.0_r + e.arena_e) * v);
+    normal = vec3() - touch.normal;
+    return true;
+}
+
+void Simulator::collide_entities(Entity& a, Entity& b) const
+{
+    const vec3 delta = b.pos - a.pos;
+    const real_t dist = delta.len();
+    const real_t penetration = a.radius + b.radius - dist;
+    if (penetration <= 0)
+    {
+        return;
+    }
+
+    const real_t k_a = b.mass / (a.mass + b.mass);
+    const real_t k_b = a.mass / (a.mass + b.mass);
+    const vec3 normal = delta / dist;
+    a.pos -= normal * (penetration * k_a);
+    b.pos += normal * (penetration * k_b);
+
+    // Both growing radii close the gap, whichever side they are on
+    const real_t delta_vel = (b.vel - a.vel).dot(normal) - b.radius_change_speed - a.radius_change_speed;
+    if (delta_vel < 0)
+    {
+        const vec3 impulse = normal * ((1.0_r + m_hit_e) * delta_vel);
+        a.vel += impulse * k_a;
+        b.vel -= impulse * k_b;
+    }
+}
+
+// On the arena a robot runs towards the target velocity along the surface it touches,
+// the steeper the surface the weaker it pushes
+void Simulator::run(Entity& bot, real_t dt) const
+{
+    if (bot.touch)
+    {
+        vec3 target_vel = vec3::clamp(bot.target_vel, m_robot_max_ground_speed);
+        target_vel -= bot.normal * bot.normal.dot(target_vel);
+        const vec3 change = target_vel - bot.vel;
+        const real_t change_len = change.len();
+        if (change_len > 0)
+        {
+            const real_t acceleration = m_robot_acceleration * max(0.0_r, bot.normal.y);
+            bot.vel += vec3::clamp(change * (acceleration * dt / change_len), change_len);
+        }
+    }
+}
+
+void Simulator::update(World& world, real_t dt)
+{
+    Entity* const bots = world.bots;
+    const int bot_count = world.bot_count;
+    for (Entity* bot = bots; bot != bots + bot_count; ++bot)
+    {
+        run(*bot, dt);
+
+        if (bot->use_nitro)
+        {
+            const vec3 change = vec3::clamp(bot->target_vel - bot->vel, bot->nitro * m_nitro_point_velocity_change);
+            const real_t change_len = change.len();
+            if (change_len > 0)
+            {
+                const vec3 vel_change = vec3::clamp(change * (m_nitro_acceleration * dt / change_len), change_len);
+                bot->vel += vel_change;
+                bot->nitro -= vel_change.len() / m_nitro_point_velocity_change;
+            }
+        }
+
+        move(*bot, dt);
+        bot->radius = m_robot_min_radius + (m_robot_max_radius - m_robot_min_radius) * bot->jump_speed / m_robot_max_jump_speed;
+        bot->radius_change_speed = bot->jump_speed;
+    }
+
+    move(world.ball, dt);
+
+    for (int i = 0; i < bot_count; ++i)
+    {
+        for (int j = 0; j < i; ++j)
+        {
+            collide_entities(bots[i], bots[j]);
+        }
+    }
+
+    for (Entity* bot = bots; bot != bots + bot_count; ++bot)
+    {
+        collide_entities(*bot, world.ball);
+        bot->touch = collide_arena(*bot, bot->normal);
+    }
+
+    vec3 normal;
+    collide_arena(world.ball, normal);
+
+    if (abs(world.ball.pos.z) > m_goal_line)
+    {
+        world.goal = (world.ball.pos.z > 0) ? 1 : -1;
+    }
+
+    for (Entity* bot = bots; bot != bots + bot_count; ++bot)
+    {
+        if (bot->nitro >= m_max_nitro)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < world.pack_count; ++i)
+        {
+            World::NitroPack& pack = world.packs[i];
+            if (pack.alive && bot->pos.dist(pack.pos) <= bot->radius + pack.radius)
+            {
+                bot->nitro = m_max_nitro;
+                pack.alive = false;
+                pack.respawn_ticks = m_nitro_respawn_ticks;
+            }
+        }
+    }
+}
+
+void Simulator::tick(World& world)
+{
+    for (int utick = 0; utick < m_microticks && 0 == world.goal; ++utick)
+    {
+        update(world, m_microstep);
+    }
+
+    for (int i = 0; i < world.pack_count; ++i)
+    {
+        World::NitroPack& pack = world.packs[i];
+        if (!pack.alive && 0 == --pack.respawn_ticks)
+        {
+            pack.alive = true;
+        }
+    }
+}
+
+// Every microtick a rolling ball sinks under the floor by g*dt^2/2 and bounces back
+// with arena_e of the vertical speed it got, that speed converges to e*g*dt/(1+e)
+// in a few microticks. A ball that can not bounce higher than the tolerance over the
+// floor is put right into that state, the microticks would only differ by the tiny
+// bounces it makes on its way there.
+bool Simulator::can_roll(const Entity& e, int microticks) const
+{
+    const real_t lift = e.pos.y - e.radius;
+    const real_t bounce = lift + e.vel.y * e.vel.y / (2.0_r * m_gravity);
+    if ((bounce > m_tolerance) | (lift < -m_tolerance) | (e.radius_change_speed != 0))
+    {
+        return false;
+    }
+
+    const real_t duration = m_microstep * (real_t)microticks;
+    const real_t reach = sqrt(e.vel.x * e.vel.x + e.vel.z * e.vel.z) * duration;
+    return (e.vel.len() + m_gravity * m_microstep <= m_max_entity_speed)
+        && m_arena->floor_only(e.pos, e.radius, reach);
+}
+
+bool Simulator::roll(Entity& e, int microticks) const
+{
+    if (!can_roll(e, microticks))
+    {
+        return false;
+    }
+
+    const real_t duration = m_microstep * (real_t)microticks;
+    e.pos.x += e.vel.x * duration;
+    e.pos.z += e.vel.z * duration;
+    e.pos.y = e.radius;
+    e.vel.y = rest_vel(e);
+    return true;
+}
+
+real_t Simulator::rest_vel(const Entity& e) const
+{
+    const real_t g_dt = m_gravity * m_microstep;
+    return e.arena_e * g_dt / (1.0_r + e.arena_e);
+}
+
+// Microticks the entity surely flies without touching the arena, up to the given count.
+int Simulator::free_microticks(const Entity& e, int microticks) const
+{
+    const real_t duration = m_microstep * (real_t)microticks;
+    if (e.vel.len() + m_gravity * duration > m_max_entity_speed)
+    {
+        // The speed clamp would bend the path
+        return 0;
+    }
+
+    int free = 0;
+    return parabola_microticks(e, microticks, free) ? free : march_microticks(e, microticks);
+}
+
+// Only the floor (and the ceiling in the open field) within reach, the contact is a root of the parabola.
+// Microticks are checked at their ends, the first one past the root is the first contact.
+bool Simulator::parabola_microticks(const Entity& e, int microticks, int& free) const
+{
+    const ArenaModel& model = *m_arena;
+    const real_t duration = m_microstep * (real_t)microticks;
+    const real_t reach = sqrt(e.vel.x * e.vel.x + e.vel.z * e.vel.z) * duration;
+    const bool open = model.open_field(e.pos, e.radius + reach);
+    vec3 top = e.pos;
+    top.y += (e.vel.y > 0) ? e.vel.y * e.vel.y / (2.0_r * m_gravity) : 0.0_r;
+    if (!open && !model.floor_only(top, e.radius, reach))
+    {
+        return false;
+    }
+
+    free = 0;
+    const real_t floor_gap = e.pos.y - e.radius;
+    const real_t ceiling_gap = m_arena_height - e.radius - e.pos.y;
+    if ((floor_gap <= 0) | (ceiling_gap <= 0))
+    {
+        return true;
+    }
+
+    real_t contact = (e.vel.y + sqrt(e.vel.y * e.vel.y + 2.0_r * m_gravity * floor_gap)) / m_gravity;
+    const real_t rise = e.vel.y * e.vel.y - 2.0_r * m_gravity * ceiling_gap;
+    if (open & (e.vel.y > 0) & (rise >= 0))
+    {
+        contact = min(contact, (e.vel.y - sqrt(rise)) / m_gravity);
+    }
+    free = (int)min((real_t)microticks, max(0.0_r, ceil(contact / m_microstep) - 1.0_r));
+    return true;
+}
+
+// The field is 1-Lipschitz and in the time dt the arc gets no farther than speed*dt + g*dt^2/2
+// from where it is, so it can not reach the arena before that covers the clearance.
+int Simulator::march_microticks(const Entity& e, int microticks) const
+{
+    const real_t duration = m_microstep * (real_t)microticks;
+    real_t t = 0.0_r;
+    for (int i = 0; i < 16 && t < duration; ++i)
+    {
+        vec3 pos = e.pos + e.vel * t;
+        pos.y -= m_gravity * t * t / 2.0_r;
+        vec3 vel = e.vel;
+        vel.y -= m_gravity * t;
+        vec3 normal;
+        const real_t gap = m_arena->distance(pos, normal) - e.radius;
+        const real_t speed = vel.len();
+        const real_t step = 2.0_r * gap / (speed + sqrt(max(0.0_r, speed * speed + 2.0_r * m_gravity * gap)));
+        // Not worth going on once a step falls short of a microtick
+        if (step < m_microstep)
+        {
+            break;
+        }
+        t += step;
+    }
+    return (int)min((real_t)microticks, floor(t / m_microstep));
+}
+
+Entity Simulator::tick_alone(const Entity& e) const
+{
+    auto ret = e;
+    vec3 normal;
+    int microticks = m_microticks;
+    // Sliding along a wall every look ahead fails, they get rarer the longer it lasts
+    int wait = 0;
+    int backoff = 1;
+    while (microticks > 0 && !roll(ret, microticks))
+    {
+        const int free = (wait > 0) ? 0 : free_microticks(ret, microticks);
+        if (free > 0)
+        {
+            move(ret, m_microstep * (real_t)free);
+            microticks -= free;
+            backoff = 1;
+            continue;
+        }
+
+        if (wait > 0)
+        {
+            --wait;
+        }
+        else
+        {
+            wait = backoff;
+            backoff = min(backoff * 2, 16);
+        }
+
+        move(ret, m_microstep);
+        collide_arena(ret, normal);
+        --microticks;
+    }
+    return ret;
+}
+
+int Simulator::free_ticks(const Entity& e, int max_ticks, bool& rolling) const
+{
+    // Only a ball already settled on the floor keeps the same state from tick to tick
+    rolling = (e.pos.y == e.radius) & (e.vel.y == rest_vel(e));
+    if (rolling)
+    {
+        int ret = 0;
+        for (int ticks = 1; ret < max_ticks && can_roll(e, ticks * m_microticks); ticks = min(ticks * 2, max_ticks))
+        {
+            ret = ticks;
+        }
+        return ret;
+    }
+
+    // Not as far as the speed clamp would bend the path
+    const real_t speed_margin = (m_max_entity_speed - e.vel.len()) / m_gravity;
+    max_ticks = (int)min((real_t)max_ticks, floor(speed_margin / m_timestep));
+
+    // The open field reach grows with the time, it is cheap to check for shorter looks.
+    // The march does not depend on how far it looks, it goes once.
+    for (int ticks = max_ticks; ticks > 0; ticks /= 2)
+    {
+        int free = 0;
+        if (parabola_microticks(e, ticks * m_microticks, free))
+        {
+            return free / m_microticks;
+        }
+    }
+    return (max_ticks > 0) ? march_microticks(e, max_ticks * m_microticks) / m_microticks : 0;
+}
+
+Entity Simulator::tick_alone_microticks(const Entity& e) const
+{
+    auto ret = e;
+    vec3 normal;
+    for (int utick = 0; utick < m_microticks; ++utick)
+    {
+        move(ret, m_microstep);
+        collide_arena(ret, normal);
+    }
+    return ret;
+}
+
+// Every microtick the velocity moves by ROBOT_ACCELERATION*dt straight to the target and
+// then the position moves by the new velocity. Both ends under the speed limit keep the
+// whole segment under it, so the clamp does nothing and the sums have a closed form.
+void Simulator::robot_tick(Entity& bot) const
+{
+    const real_t speed = bot.vel.len();
+    if (bot.touch && (bot.normal.y >= 1.0_r) && (0 == bot.jump_speed) && (speed <= m_robot_max_ground_speed)
+        && (abs(bot.pos.y - m_robot_min_radius) <= m_tolerance)
+        && m_arena->floor_only(bot.pos, m_robot_min_radius, m_robot_max_ground_speed * m_timestep))
+    {
+        // The floor takes every bit of the fall a microtick makes, nothing but the run is left
+        vec3 target_vel = vec3::clamp(bot.target_vel, m_robot_max_ground_speed);
+        target_vel.y = 0.0_r;
+        bot.vel.y = 0.0_r;
+        ground_tick(bot.pos, bot.vel, target_vel);
+        bot.radius = m_robot_min_radius;
+        bot.radius_change_speed = 0.0_r;
+        return;
+    }
+
+    for (int utick = 0; utick < m_microticks; ++utick)
+    {
+        run(bot, m_microstep);
+        move(bot, m_microstep);
+        bot.radius = m_robot_min_radius + (m_robot_max_radius - m_robot_min_radius) * bot.jump_speed / m_robot_max_jump_speed;
+        bot.radius_change_speed = bot.jump_speed;
+        bot.touch = collide_arena(bot, bot.normal);
+    }
+}
+
+void Simulator::ground_tick(vec3& pos, vec3& vel, const vec3& target_vel) const
+{
+    const real_t step_dv = m_robot_acceleration * m_microstep;
+    if ((vel.len() > m_robot_max_ground_speed) | (target_vel.len() > m_robot_max_ground_speed))
+    {
+        for (int utick = 0; utick < m_microticks; ++utick)
+        {
+            vel += vec3::clamp(target_vel - vel, step_dv);
+            vel.clamp(m_robot_max_ground_speed);
+            pos += vel * m_microstep;
+        }
+        return;
+    }
+
+    const vec3 change = target_vel - vel;
+    const real_t change_len = change.len();
+    // Microticks still short of the target, the rest of them run at the target speed
+    const int accelerating = (int)min((real_t)m_microticks, max(0.0_r, ceil(change_len / step_dv) - 1.0_r));
+    const int steady = m_microticks - accelerating;
+    if (accelerating > 0)
+    {
+        const vec3 dv = change * (step_dv / change_len);
+        pos += (vel * (real_t)accelerating + dv * (real_t)(accelerating * (accelerating + 1) / 2)) * m_microstep;
+        vel += dv * (real_t)accelerating;
+    }
+    if (steady > 0)
+    {
+        pos += target_vel * (m_microstep * (real_t)steady);
+        vel = target_vel;
+    }
+}
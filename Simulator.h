@@ -0,0 +1,100 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _SIMULATOR_H_
+#define _SIMULATOR_H_
+
+#include <vector>
+#include "linal.h"
+#include "model/Rules.h"
+#include "ArenaModel.h"
+#include "World.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Game physics, the same steps the server makes: robots accelerate, use nitro
+// and jump, everybody moves, then robots hit each other, the ball and the arena.
+// Hits are not random here, every one of them uses the mean of MIN_HIT_E and MAX_HIT_E.
+// Robots are processed in the order of their World slots, the server shuffles them.
+//
+class Simulator
+{
+public:
+    Simulator() {}
+    // Tolerance is how high over the floor a ball may bounce and still count as rolling, see tick_alone()
+    Simulator(const model::Rules& rules, const ArenaModel& arena, linal::real_t tolerance = 1e-4_r);
+
+    // One game tick of the whole world, MICROTICKS_PER_TICK updates.
+    // Stops updating once the ball is in a goal, see World::goal.
+    void tick(World& world);
+
+    // One tick of an entity nobody else touches (the ball on its own).
+    // Free flight goes in one step up to the microtick of the first contact, the contact
+    // time is the root of the parabola in the open field and a conservative march over
+    // the distance field elsewhere. Only the microticks around an impact are stepped one by one.
+    // Rolling on the floor has a closed form. Matches tick_alone_microticks() up to rounding,
+    // except that a ball bouncing within the tolerance over the floor is put right onto it
+    // (off by the tolerance in height and by sqrt(2*g*tolerance) in vertical speed).
+    Entity tick_alone(const Entity& e) const;
+
+    // Reference for tick_alone(), every microtick stepped and checked against the arena.
+    Entity tick_alone_microticks(const Entity& e) const;
+
+    // Whole ticks, up to max_ticks, tick_alone() would take the entity along the same
+    // parabola (or, when rolling is set, along the floor at the same speed) without touching anything.
+    int free_ticks(const Entity& e, int max_ticks, bool& rolling) const;
+
+    // One tick of a robot nobody else touches, the same microticks tick() makes for it except
+    // that nitro is not used. On the arena the robot runs towards target_vel along the surface
+    // (the plane of the touch normal), on the ramps and walls it moves and collides like the ball.
+    // Running on the flat floor with the walls out of reach takes the closed form of ground_tick().
+    void robot_tick(Entity& bot) const;
+
+    // One tick of a robot running on the floor towards target_vel, same as
+    // MICROTICKS_PER_TICK steps of ROBOT_ACCELERATION but in closed form.
+    void ground_tick(linal::vec3& pos, linal::vec3& vel, const linal::vec3& target_vel) const;
+
+    linal::real_t timestep() const { return m_timestep; }
+    linal::real_t microstep() const { return m_microstep; }
+    linal::real_t tolerance() const { return m_tolerance; }
+    linal::real_t gravity() const { return m_gravity; }
+    // Ball center past it along z is in a goal
+    linal::real_t goal_line() const { return m_goal_line; }
+
+private:
+    void run(Entity& bot, linal::real_t dt) const;
+    void update(World& world, linal::real_t dt);
+    void move(Entity& e, linal::real_t dt) const;
+    bool collide_arena(Entity& e, linal::vec3& normal) const;
+    void collide_entities(Entity& a, Entity& b) const;
+    bool can_roll(const Entity& e, int microticks) const;
+    bool roll(Entity& e, int microticks) const;
+    linal::real_t rest_vel(const Entity& e) const;
+    int free_microticks(const Entity& e, int microticks) const;
+    bool parabola_microticks(const Entity& e, int microticks, int& free) const;
+    int march_microticks(const Entity& e, int microticks) const;
+
+    const ArenaModel* m_arena = nullptr;
+
+    int m_microticks = 1;
+    linal::real_t m_timestep = 0.0_r;
+    linal::real_t m_microstep = 0.0_r;
+    linal::real_t m_tolerance = 0.0_r;
+    linal::real_t m_gravity = 0.0_r;
+    linal::real_t m_arena_height = 0.0_r;
+    linal::real_t m_max_entity_speed = 0.0_r;
+    linal::real_t m_hit_e = 0.0_r;
+    linal::real_t m_goal_line = 0.0_r;
+    linal::real_t m_robot_min_radius = 0.0_r;
+    linal::real_t m_robot_max_radius = 0.0_r;
+    linal::real_t m_robot_max_jump_speed = 0.0_r;
+    linal::real_t m_robot_acceleration = 0.0_r;
+    linal::real_t m_robot_max_ground_speed = 0.0_r;
+    linal::real_t m_nitro_acceleration = 0.0_r;
+    linal::real_t m_nitro_point_velocity_change = 0.0_r;
+    linal::real_t m_max_nitro = 0.0_r;
+    int m_nitro_respawn_ticks = 0;
+};
+
+#endif // _SIMULATOR_H_
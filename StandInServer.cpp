@@ -0,0 +1,161 @@
+#include "StandInServer.h"
+
+#ifdef MY_BENCHMARK
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.h"
+#include "JsonDecoder.h"
+#include "BinaryProtocol.h"
+using namespace std;
+using namespace model;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+bool StandInServer::listen(int port)
+{
+    return m_socket.Initialize() && m_socket.Listen(reinterpret_cast<const uint8*>("127.0.0.1"), (int16)port);
+}
+
+bool StandInServer::receive(CActiveSocket& client)
+{
+    const int32 size = 8 * 1024;
+    const int32 received = client.ReceiveInto(reinterpret_cast<uint8*>(m_buffer.reserve(size)), size);
+    if (received <= 0)
+    {
+        return false;
+    }
+    m_buffer.commit(received);
+    return true;
+}
+
+bool StandInServer::send(CActiveSocket& client, const char* data, size_t size, Report& report)
+{
+    report.bytes_sent += size;
+    return client.Send(reinterpret_cast<const uint8*>(data), size) == (int32)size;
+}
+
+bool StandInServer::serve(const string& stream, Report& report)
+{
+    unique_ptr<CActiveSocket> client(m_socket.Accept());
+    if (!client)
+    {
+        return false;
+    }
+    client->DisableNagleAlgoritm();
+
+    // The protocol line, then the token
+    report = Report();
+    for (int i = 0; i < 2; ++i)
+    {
+        string_view line;
+        while (!(line = m_buffer.next_line()).data())
+        {
+            if (!receive(*client))
+            {
+                return false;
+            }
+        }
+        report.binary = report.binary || (0 == i && line == "binary");
+    }
+
+    // Messages to send, converted before the match so that the conversion is not timed
+    vector<string> messages;
+    string text;
+    Rules rules;
+    Game game;
+    vector<char> frame;
+    for (size_t begin = 0, eol; (eol = stream.find('\n', begin)) != string::npos; begin = eol + 1)
+    {
+        text.assign(stream, begin, eol + 1 - begin);
+        if (report.binary)
+        {
+            text.back() = '\0';
+            frame.clear();
+            const bool ok = messages.empty() ? JsonDecoder::read(&text[0], rules) : JsonDecoder::read(&text[0], game);
+            if (!ok)
+            {
+                return false;
+            }
+            messages.empty() ? BinaryProtocol::write(rules, frame) : BinaryProtocol::write(game, frame);
+            text.assign(frame.data(), frame.size());
+        }
+        messages.push_back(text);
+    }
+    if (messages.empty() || !send(*client, messages[0].data(), messages[0].size(), report))
+    {
+        return false;
+    }
+
+    unordered_map<int, Action> actions;
+    string custom_rendering;
+    for (size_t tick = 1; tick < messages.size(); ++tick)
+    {
+        const auto start = chrono::steady_clock::now();
+        if (!send(*client, messages[tick].data(), messages[tick].size(), report))
+        {
+            return false;
+        }
+
+        // An answer is a frame, or JSON lines up to "<end>"
+        for (bool answered = false; !answered; )
+        {
+            const string_view answer = report.binary ? m_buffer.next_frame() : m_buffer.next_line();
+            if (!answer.data())
+            {
+                if (!receive(*client))
+                {
+                    return false;
+                }
+                continue;
+            }
+            report.bytes_received += answer.size() + (report.binary ? BinaryProtocol::header_size : 1);
+            if (report.binary)
+            {
+                answered = BinaryProtocol::read(answer, actions, custom_rendering);
+                if (!answered)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                answered = (answer == "<end>");
+            }
+        }
+        report.round_trip_ns += (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        ++report.ticks;
+    }
+    client->Close();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+int RunStandInServer(int port, const char* match_file)
+{
+    const string stream = MatchStream(match_file, 5000);
+    StandInServer server;
+    if (!server.listen(port))
+    {
+        fprintf(stderr, "Failed to listen on port %d\n", port);
+        return 1;
+    }
+    printf("serving %s on port %d\n", match_file ? match_file : "the benchmark match", port);
+
+    StandInServer::Report report;
+    const bool ok = server.serve(stream, report);
+    const int ticks = max(report.ticks, 1);
+    printf("%s %s: %d ticks, round trip %.1f us per tick, %.0f bytes sent and %.0f received per tick\n"
+        , report.binary ? "binary" : "json", ok ? "done" : "client lost", report.ticks
+        , report.round_trip_ns / ticks / 1e3, (double)report.bytes_sent / ticks, (double)report.bytes_received / ticks);
+    return ok ? 0 : 1;
+}
+
+#endif // MY_BENCHMARK
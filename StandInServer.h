@@ -0,0 +1,51 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _STAND_IN_SERVER_H_
+#define _STAND_IN_SERVER_H_
+
+#ifdef MY_BENCHMARK
+#include <string>
+#include "csimplesocket/PassiveSocket.h"
+#include "LineBuffer.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Local server for measuring the client side of the protocol. Plays a recorded match stream
+// (the rules line and a line per tick, as the real server sends them) to one client in lockstep:
+// a tick goes out, the answer is waited for, then the next tick. Speaks JSON or the binary
+// protocol (BinaryProtocol.h), as the client asks in its first line. Nothing is simulated,
+// the answers are only framed and counted.
+//
+class StandInServer
+{
+public:
+    struct Report
+    {
+        bool binary = false;
+        int ticks = 0;
+        size_t bytes_sent = 0;
+        size_t bytes_received = 0;
+        double round_trip_ns = 0.0;     // from the tick sent to its answer received, summed up
+    };
+
+    // Before the client connects, the client may be started right after it
+    bool listen(int port);
+
+    // One client, the whole match. False when the client went away before the end.
+    bool serve(const std::string& stream, Report& report);
+
+private:
+    bool receive(CActiveSocket& client);
+    bool send(CActiveSocket& client, const char* data, size_t size, Report& report);
+
+    CPassiveSocket m_socket;
+    LineBuffer m_buffer;
+};
+
+// "serve <port> [match.jsonl]" of the benchmark build
+int RunStandInServer(int port, const char* match_file);
+#endif
+
+#endif // _STAND_IN_SERVER_H_
@@ -1,3 +1,14 @@
 #include "Strategy.h"
 
 Strategy::~Strategy() { }
+
+void Strategy::act_team(const model::Rules& rules, const model::Game& game, std::unordered_map<int, model::Action>& actions) {
+    // Same robots every tick, the map keeps its nodes
+    for (const model::Robot& robot : game.robots) {
+        if (robot.is_teammate) {
+            model::Action& action = actions[robot.id];
+            action = model::Action();
+            act(robot, rules, game, action);
+        }
+    }
+}
@@ -9,11 +9,17 @@
 #include "model/Game.h"
 #include "model/Action.h"
 #include "model/Robot.h"
+#include <unordered_map>
 
 class Strategy {
 public:
     virtual void act(const model::Robot& me, const model::Rules& rules, const model::Game& game, model::Action& action) = 0;
+    // Actions of all teammates for the tick, keyed by robot id. By default act() for each of them.
+    virtual void act_team(const model::Rules& rules, const model::Game& game, std::unordered_map<int, model::Action>& actions);
     virtual std::string custom_rendering() { return ""; }
+    // Changes whenever the strategy makes a new plan, stays the same while it plays on the plan it has.
+    // Always 0 for a strategy that does not tell.
+    virtual unsigned plan_version() const { return 0; }
 
     virtual ~Strategy();
 };
@@ -0,0 +1,88 @@
+#include "ThreadPool.h"
+#include <algorithm>
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+ThreadPool::ThreadPool(int threads)
+{
+    for (int i = 1; i < max(threads, 1); ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::dispatch(int count, Call call, void* context)
+{
+    if (m_workers.empty() || count <= 1)
+    {
+        for (int item = 0; item < count; ++item)
+        {
+            call(context, item);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_call = call;
+        m_context = context;
+        m_count = count;
+        m_next = 0;
+        m_busy = (int)m_workers.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    take_items();
+
+    unique_lock<mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return 0 == m_busy; });
+}
+
+void ThreadPool::take_items()
+{
+    for (int item; (item = m_next.fetch_add(1)) < m_count; )
+    {
+        m_call(m_context, item);
+    }
+}
+
+void ThreadPool::work()
+{
+    unsigned generation = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_start.wait(lock, [&]() { return m_stop || (generation != m_generation); });
+            if (m_stop)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        take_items();
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            --m_busy;
+        }
+        m_done.notify_one();
+    }
+}
@@ -0,0 +1,62 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Fixed set of threads running the items of a job: task(i) for every i in [0, count).
+// The calling thread takes items too, so a pool of one thread has no workers and runs
+// the job in place. Items are handed out one by one, every task writes its own results.
+// The outcome does not depend on how many threads there are as long as what the tasks
+// share comes out the same whichever of them gets to it first.
+//
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads = 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int threads() const { return (int)m_workers.size() + 1; }
+
+    // Returns once every item is done
+    template <class Task>
+    void run(int count, Task& task)
+    {
+        dispatch(count, [](void* context, int item) { (*static_cast<Task*>(context))(item); }, &task);
+    }
+
+private:
+    typedef void(*Call)(void* context, int item);
+
+    void dispatch(int count, Call call, void* context);
+    void work();
+    void take_items();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    unsigned m_generation = 0;          // bumped for every job, wakes the workers
+    bool m_stop = false;
+
+    // The current job
+    Call m_call = nullptr;
+    void* m_context = nullptr;
+    int m_count = 0;
+    std::atomic<int> m_next{ 0 };
+    int m_busy = 0;                     // workers still on the job
+};
+
+#endif // _THREAD_POOL_H_
@@ -0,0 +1,40 @@
+#include "TimeBudget.h"
+#include <algorithm>
+using namespace std;
+
+// Share of the budget kept for everything but the planners
+static const double s_reserve = 0.15;
+// How many even shares a tick may take
+static const double s_burst = 3.0;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+void TimeBudget::start_match(double seconds, int ticks)
+{
+    m_budget = max(seconds, 0.0) * (1.0 - s_reserve);
+    m_ticks = max(ticks, 1);
+    m_used = 0.0;
+}
+
+void TimeBudget::start_tick(int tick)
+{
+    m_tick = tick;
+    m_cut = false;
+    const int ticks_left = max(m_ticks - tick, 1);
+    m_allowance = max(left(), 0.0) / ticks_left * s_burst;
+    m_allowance = min(m_allowance, max(left(), 0.0));
+    m_start = clock::now();
+    m_deadline = m_start + chrono::duration_cast<clock::duration>(chrono::duration<double>(m_allowance));
+}
+
+void TimeBudget::end_tick(int depth)
+{
+    const double spent = chrono::duration<double>(clock::now() - m_start).count();
+    m_used += spent;
+    m_deadline = clock::time_point::max();
+    if (m_log)
+    {
+        fprintf(m_log, "%d,%.0f,%.0f,%.3f,%d,%d\n", m_tick, m_allowance * 1e6, spent * 1e6, left(), depth, m_cut ? 1 : 0);
+    }
+}
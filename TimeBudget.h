@@ -0,0 +1,58 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _TIME_BUDGET_H_
+#define _TIME_BUDGET_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Time of the whole match handed out tick by tick. Every tick gets a deadline: an even share
+// of the time left over the ticks left, times the burst factor, so the time saved by quick
+// ticks goes to the ones that need it. Part of the budget is held back for the time spent
+// outside of the planners (the protocol, the OS), only the planning time is counted.
+// Planners look at expired() as they go and stop with the best answer found so far.
+//
+class TimeBudget
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    // The match budget in seconds, for so many ticks
+    void start_match(double seconds, int ticks);
+
+    void start_tick(int tick);
+
+    // Depth is how far the planners got this tick (ticks ahead), for the log
+    void end_tick(int depth);
+
+    bool expired() const { return clock::now() >= m_deadline; }
+
+    // A planner stopped on the deadline, shows up in the log. May be called from the pool threads.
+    void cut() { m_cut.store(true, std::memory_order_relaxed); }
+
+    double allowance() const { return m_allowance; }
+    double used() const { return m_used; }
+    double left() const { return m_budget - m_used; }
+
+    // A line per tick: tick, allowance and time used in microseconds, seconds left,
+    // depth, 1 when cut. Null turns it off.
+    void set_log(FILE* log) { m_log = log; }
+
+private:
+    double m_budget = 0.0;              // seconds for the planners, the reserve taken off
+    int m_ticks = 0;
+    double m_used = 0.0;
+    double m_allowance = 0.0;
+    int m_tick = 0;
+    std::atomic<bool> m_cut{ false };
+    clock::time_point m_start;
+    clock::time_point m_deadline = clock::time_point::max();
+    FILE* m_log = nullptr;
+};
+
+#endif // _TIME_BUDGET_H_
@@ -0,0 +1,95 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _WORLD_H_
+#define _WORLD_H_
+
+#include <type_traits>
+#include "linal.h"
+using linal::operator""_r;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+struct alignas(16) Entity
+{
+    linal::vec3 pos;
+    linal::vec3 vel;
+    linal::real_t nitro = 0.0_r;
+    linal::real_t radius = 0.0_r;
+    linal::real_t mass = 0.0_r;
+    linal::real_t arena_e = 0.0_r;
+    linal::real_t radius_change_speed = 0.0_r;
+    linal::vec3 normal;                 // touch normal, from the arena into the field
+    bool touch = false;
+
+    // Robot action for the simulated tick
+    linal::vec3 target_vel;
+    linal::real_t jump_speed = 0.0_r;
+    bool use_nitro = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Everything the simulation needs of a game, in fixed arrays. Robots sit in dense slots,
+// teammates first and opponents after them, the slot of an id is assigned once (see add_bot())
+// and stays for the game. A World holds no pointers, copying one is a memcpy.
+//
+struct World
+{
+    static const int max_bots = 6;     // team_size 3
+    static const int max_packs = 4;
+
+    struct NitroPack
+    {
+        linal::vec3 pos;
+        linal::real_t radius = 0.0_r;
+        int respawn_ticks = 0;
+        bool alive = true;
+    };
+
+    Entity ball;
+    Entity bots[max_bots];
+    NitroPack packs[max_packs];
+    int ids[max_bots] = {};             // robot id of the slot
+    int bot_count = 0;
+    int teammates = 0;                  // slots [0, teammates) are ours
+    int pack_count = 0;
+    int goal = 0;                       // sign of z of the goal the ball went into, zero while in play
+
+    // Slot for the robot, teammates have to come before the opponents. -1 when full.
+    int add_bot(int id, bool teammate);
+    // Slot of the robot, -1 when it has none
+    int slot(int id) const;
+
+    Entity& bot(int id) { return bots[slot(id)]; }
+    const Entity& bot(int id) const { return bots[slot(id)]; }
+};
+
+inline int World::add_bot(int id, bool teammate)
+{
+    if (bot_count >= max_bots || (teammate && teammates < bot_count))
+    {
+        return -1;
+    }
+    ids[bot_count] = id;
+    teammates += teammate ? 1 : 0;
+    return bot_count++;
+}
+
+inline int World::slot(int id) const
+{
+    for (int i = 0; i < bot_count; ++i)
+    {
+        if (ids[i] == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static_assert(std::is_trivially_copyable<World>::value, "World is copied with memcpy");
+
+#endif // _WORLD_H_
@@ -0,0 +1,76 @@
+#include "WorldState.h"
+#include <cassert>
+#include <cstring>
+#include "Simulator.h"
+
+using namespace linal;
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+void WorldState::advance(Simulator& sim)
+{
+    ++tick;
+    ++version;
+    if (reset_ticks > 0)
+    {
+        --reset_ticks;
+        return;
+    }
+    if (0 != world.goal)
+    {
+        return;
+    }
+    sim.tick(world);
+    if (0 != world.goal)
+    {
+        // Our goal is at the negative z
+        score[(world.goal > 0) ? 0 : 1] += 1;
+        reset_ticks = reset_delay;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//
+WorldUndo::WorldUndo(size_t reserve)
+{
+    m_log.reserve(reserve);
+}
+
+void WorldUndo::save(const WorldState& state, const void* field, size_t size)
+{
+    const char* base = reinterpret_cast<const char*>(&state);
+    const char* from = static_cast<const char*>(field);
+    assert(from >= base && from + size <= base + sizeof(WorldState));
+
+    const Record record = { (uint32_t)(from - base), (uint32_t)size };
+    const size_t at = m_log.size();
+    m_log.resize(at + size + sizeof(Record));
+    memcpy(&m_log[at], from, size);
+    memcpy(&m_log[at + size], &record, sizeof(Record));
+}
+
+void WorldUndo::save_tick(const WorldState& state)
+{
+    const World& world = state.world;
+    save(state, &world.ball, sizeof(Entity));
+    save(state, &world.bots[0], world.bot_count * sizeof(Entity));
+    save(state, &world.packs[0], world.pack_count * sizeof(World::NitroPack));
+    save(state, &world.goal, sizeof(world.goal));
+    save(state, &state.tick, offsetof(WorldState, version) + sizeof(state.version) - offsetof(WorldState, tick));
+}
+
+void WorldUndo::undo(WorldState& state, size_t mark)
+{
+    char* base = reinterpret_cast<char*>(&state);
+    while (m_log.size() > mark)
+    {
+        Record record;
+        const size_t end = m_log.size() - sizeof(Record);
+        memcpy(&record, &m_log[end], sizeof(Record));
+        memcpy(base + record.offset, &m_log[end - record.size], record.size);
+        m_log.resize(end - record.size);
+    }
+}
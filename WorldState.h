@@ -0,0 +1,76 @@
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif
+
+#ifndef _WORLD_STATE_H_
+#define _WORLD_STATE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "World.h"
+
+class Simulator;
+
+//////////////////////////////////////////////////////////////////////////
+//
+// The whole game a search plays forward: the world and the score, the tick and the reset
+// after a goal. A value, a snapshot is an assignment and so is a restore. The version goes up
+// with every change, two states of the same line of play with the same version are the same.
+//
+struct alignas(64) WorldState
+{
+    World world;
+
+    // Kept together after the world, WorldUndo saves them in one piece
+    int tick = 0;
+    int score[2] = {};                  // ours, theirs
+    int reset_ticks = 0;                // ticks left until the server sets up the kick off again, 0 in play
+    int reset_delay = 0;                // RESET_TICKS
+    uint32_t version = 0;
+
+    // One tick ahead. After a goal the world stands still, where the robots come back is up to the server.
+    void advance(Simulator& sim);
+};
+
+static_assert(std::is_trivially_copyable<WorldState>::value, "WorldState is copied with memcpy");
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Undo log for deep searches: the parts of a state about to change are saved before they do,
+// undo() puts them back down to a mark. Costs the bytes that change instead of a whole state
+// a ply, the log keeps its memory between the searches.
+//
+class WorldUndo
+{
+public:
+    explicit WorldUndo(size_t reserve = 1 << 16);
+
+    // Position to undo() back to
+    size_t mark() const { return m_log.size(); }
+
+    // Any piece of the state, by address
+    void save(const WorldState& state, const void* field, size_t size);
+
+    void save_ball(const WorldState& state) { save(state, &state.world.ball, sizeof(Entity)); }
+    void save_bot(const WorldState& state, int slot) { save(state, &state.world.bots[slot], sizeof(Entity)); }
+    // Everything WorldState::advance() may change
+    void save_tick(const WorldState& state);
+
+    // Back to the state at the mark, the latest saves first
+    void undo(WorldState& state, size_t mark);
+
+    size_t bytes() const { return m_log.size(); }
+
+private:
+    struct Record
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    std::vector<char> m_log;            // saved bytes, each followed by its Record
+};
+
+#endif // _WORLD_STATE_H_
@@ -157,6 +157,7 @@ extern "C"
 #define CONNECT(a,b,c)         connect(a,b,c)
 #define CLOSE(a)               closesocket(a)
 #define READ(a,b,c)            _read(a,b,c)
+#define READV(a,b,c)           Readv(b, c)
 #define RECV(a,b,c,d)          recv(a, (char *)b, c, d)
 #define RECVFROM(a,b,c,d,e,f)  recvfrom(a, (char *)b, c, d, (sockaddr *)e, (int *)f)
 #define RECV_FLAGS             MSG_WAITALL
@@ -181,6 +182,7 @@ extern "C"
 #define CONNECT(a,b,c)         connect(a,b,c)
 #define CLOSE(a)               close(a)
 #define READ(a,b,c)            read(a,b,c)
+#define READV(a,b,c)           readv(a, b, c)
 #define RECV(a,b,c,d)          recv(a, (void *)b, c, d)
 #define RECVFROM(a,b,c,d,e,f)  recvfrom(a, (char *)b, c, d, (sockaddr *)e, f)
 #define RECV_FLAGS             MSG_WAITALL
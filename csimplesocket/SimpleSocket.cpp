@@ -589,6 +589,29 @@ int32 CSimpleSocket::Writev(const struct iovec *pVector, size_t nCount)
 }
 
 
+//------------------------------------------------------------------------------
+//
+// Readv -
+//
+//------------------------------------------------------------------------------
+int32 CSimpleSocket::Readv(const struct iovec *pVector, size_t nCount)
+{
+    //--------------------------------------------------------------------------
+    // A single receive into the first block that has room, receiving into  
+    // the next one could block while the data already received waits.     
+    //--------------------------------------------------------------------------
+    for (size_t i = 0; i < nCount; i++)
+    {
+        if (pVector[i].iov_len > 0)
+        {
+            return RECV(m_socket, pVector[i].iov_base, (int32)pVector[i].iov_len, m_nFlags);
+        }
+    }
+
+    return 0;
+}
+
+
 //------------------------------------------------------------------------------
 //
 // Send() - Send data on a valid socket via a vector of buffers.
@@ -822,6 +845,90 @@ int32 CSimpleSocket::Receive(int32 nMaxBytes)
 }
 
 
+//------------------------------------------------------------------------------
+//
+// ReceiveInto() - Attempts to receive a block of data on an established    
+//                 connection into a buffer of the caller.                  
+//                                                                          
+//------------------------------------------------------------------------------
+int32 CSimpleSocket::ReceiveInto(uint8 *pBuf, int32 nMaxBytes)
+{
+    m_nBytesReceived = 0;
+
+    if (IsSocketValid() == false)
+    {
+        return m_nBytesReceived;
+    }
+
+    SetSocketError(SocketSuccess);
+
+    m_timer.Initialize();
+    m_timer.SetStartTime();
+
+    switch (m_nSocketType)
+    {
+        case CSimpleSocket::SocketTypeTcp:
+        {
+            do 
+            {
+                m_nBytesReceived = RECV(m_socket, pBuf, nMaxBytes, m_nFlags);
+                TranslateSocketError();
+            } while ((GetSocketError() == CSimpleSocket::SocketInterrupted));
+
+            break;
+        }
+        case CSimpleSocket::SocketTypeUdp:
+        {
+            uint32 srcSize;
+                
+            srcSize = sizeof(struct sockaddr_in);
+
+            do 
+            {
+                m_nBytesReceived = RECVFROM(m_socket, pBuf, nMaxBytes, 0, 
+                                            (GetMulticast() ? &m_stMulticastGroup : &m_stClientSockaddr), &srcSize);
+                TranslateSocketError();
+            } while (GetSocketError() == CSimpleSocket::SocketInterrupted);
+
+            break;
+        }
+        default:
+            break;
+    }
+    
+    m_timer.SetEndTime();
+    TranslateSocketError();
+
+    return m_nBytesReceived;
+}
+
+
+//------------------------------------------------------------------------------
+//
+// Receive() - Receive data on a valid socket via a vector of buffers.
+//
+//------------------------------------------------------------------------------
+int32 CSimpleSocket::Receive(const struct iovec *recvVector, int32 nNumItems)
+{
+    m_nBytesReceived = 0;
+
+    if (IsSocketValid() == false)
+    {
+        return m_nBytesReceived;
+    }
+
+    SetSocketError(SocketSuccess);
+
+    do 
+    {
+        m_nBytesReceived = READV(m_socket, recvVector, nNumItems);
+        TranslateSocketError();
+    } while (GetSocketError() == CSimpleSocket::SocketInterrupted);
+
+    return m_nBytesReceived;
+}
+
+
 //------------------------------------------------------------------------------
 //
 // SetNonblocking()
@@ -206,6 +206,26 @@ public:
     /// @return of -1 means that an error has occurred.
     virtual int32 Receive(int32 nMaxBytes = 1);
 
+    /// Attempts to receive a block of data on an established connection
+    /// straight into the caller's memory.  The internal buffer is not used,
+    /// GetData() is left as it was.
+    /// @param pBuf where the data goes.
+    /// @param nMaxBytes maximum number of bytes to receive.
+    /// @return number of bytes actually received.
+    /// @return of zero means the connection has been shutdown on the other side.
+    /// @return of -1 means that an error has occurred.
+    virtual int32 ReceiveInto(uint8 *pBuf, int32 nMaxBytes);
+
+    /// Attempts to receive data on an established connection into at most
+    /// nNumItems blocks described by recvVector, filled in order, without
+    /// the internal buffer.
+    /// @param recvVector pointer to an array of iovec structures
+    /// @param nNumItems number of items in the vector to process
+    /// @return number of bytes actually received, return of zero means the
+    /// connection has been shutdown on the other side, and a return of -1
+    /// means that an error has occurred.
+    virtual int32 Receive(const struct iovec *recvVector, int32 nNumItems);
+
     /// Attempts to send a block of data on an established connection.
     /// @param pBuf block of data to be sent.
     /// @param bytesToSend size of data block to be sent.
@@ -475,6 +495,14 @@ private:
     /// means that an error has occurred.
     int32 Writev(const struct iovec *pVector, size_t nCount);
 
+    /// Attempts to receive data into the blocks described by pVector.
+    /// <br>\b Note: This implementation is for systems that don't natively
+    /// support this functionality, only the first non-empty block is filled.
+    /// @return number of bytes actually received, return of zero means the
+    /// connection has been shutdown on the other side, and a return of -1
+    /// means that an error has occurred.
+    int32 Readv(const struct iovec *pVector, size_t nCount);
+
     /// Flush the socket descriptor owned by the object.
     /// @return true data was successfully sent, else return false;
     bool Flush();
@@ -8,9 +8,77 @@
 #define USE_MATH
 #include <cmath>
 
+//////////////////////////////////////////////////////////////////////////
+//
+// vec3 arithmetic backend, picked at compile time from the target instruction set,
+// define LINAL_SIMD to one of the values below to force it. vec3 is laid out as four
+// lanes (x, y, z and a zero pad), all the backends give the same bits as plain scalar code:
+// lanes are computed independently and dot() adds up x, y and z in the same order.
+//
+// LINAL_SIMD_AVX2 keeps a vec3 in one 256-bit register. It is never picked on its own:
+// the code around writes single components all the time (pos.y = ...), and a 256-bit
+// load right after such a write misses store forwarding, the simulation gets ~35% slower.
+// AVX2 builds get the SSE2 backend, VEX encoded.
+//
+// LINAL_FAST_RSQRT switches normalize(), normal() and clamp() to a multiply by an
+// estimated 1/sqrt refined by LINAL_RSQRT_STEPS Newton steps (about 12 correct bits
+// to start with, each step doubles them). Not bit exact any more, so off by default.
+//
+// LINAL_FLOAT makes real_t a float: a vec3 fits one 128-bit register on every SIMD backend
+// and twice as many lanes fit simd::lanes. The physics drifts off the server's doubles,
+// see the "drift" benchmark for how far a predicted ball goes off per tick.
+//
+#define LINAL_SIMD_NONE 0
+#define LINAL_SIMD_SSE2 1
+#define LINAL_SIMD_AVX2 2
+
+#ifndef LINAL_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LINAL_SIMD LINAL_SIMD_SSE2
+#else
+#define LINAL_SIMD LINAL_SIMD_NONE
+#endif
+#endif
+
+#ifndef LINAL_RSQRT_STEPS
+#define LINAL_RSQRT_STEPS 2
+#endif
+
+#ifdef LINAL_FLOAT
+#define LINAL_REAL_SIZE 4
+#else
+#define LINAL_REAL_SIZE 8
+#endif
+
+// Lanes for structure-of-arrays code (simd::lanes) take the widest registers the target has,
+// whole arrays are loaded there and nothing stalls on single component writes.
+#ifndef LINAL_LANES
+#if defined(__AVX2__)
+#define LINAL_LANES (32 / LINAL_REAL_SIZE)
+#elif (LINAL_SIMD != LINAL_SIMD_NONE)
+#define LINAL_LANES (16 / LINAL_REAL_SIZE)
+#else
+#define LINAL_LANES 1
+#endif
+#endif
+
+#if (LINAL_LANES != 1) && (LINAL_LANES * LINAL_REAL_SIZE != 16) && (LINAL_LANES * LINAL_REAL_SIZE != 32)
+#error LINAL_LANES has to fill a 128-bit or a 256-bit register
+#endif
+
+#if ((LINAL_SIMD == LINAL_SIMD_AVX2) && !defined(LINAL_FLOAT)) || (LINAL_LANES * LINAL_REAL_SIZE == 32)
+#include <immintrin.h>
+#elif (LINAL_SIMD != LINAL_SIMD_NONE) || (LINAL_LANES != 1) || defined(LINAL_FAST_RSQRT)
+#include <emmintrin.h>
+#endif
+
 namespace linal {
 
+#ifdef LINAL_FLOAT
+using real_t = float;
+#else
 using real_t = double;
+#endif
 
 constexpr real_t operator"" _r(long double v){
     return (real_t)v;
@@ -20,6 +88,306 @@ constexpr real_t operator"" _deg(long double v){
     return (real_t)v * (real_t)3.1415926536 / (real_t)180.0;
 }
 
+namespace simd {
+
+#if (LINAL_SIMD != LINAL_SIMD_NONE) && defined(LINAL_FLOAT)
+
+constexpr const char* name = (LINAL_SIMD == LINAL_SIMD_AVX2) ? "avx2 float" : "sse2 float";
+
+struct pack
+{
+    __m128 v;
+};
+
+inline pack load(const real_t* p) { return { _mm_loadu_ps(p) }; }
+inline void store(real_t* p, pack a) { _mm_storeu_ps(p, a.v); }
+inline pack splat(real_t s) { return { _mm_set1_ps(s) }; }
+inline pack add(pack a, pack b) { return { _mm_add_ps(a.v, b.v) }; }
+inline pack sub(pack a, pack b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline pack mul(pack a, pack b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline pack neg(pack a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+
+// The pad lane is divided by one, 0/0 would raise FE_INVALID
+inline pack div(pack a, pack b)
+{
+    const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    return { _mm_div_ps(a.v, _mm_or_ps(_mm_and_ps(xyz, b.v), _mm_andnot_ps(xyz, _mm_set1_ps(1.0f)))) };
+}
+
+inline real_t dot(pack a, pack b)
+{
+    const __m128 m = _mm_mul_ps(a.v, b.v);
+    const __m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z = _mm_movehl_ps(m, m);
+    return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(m, y), z));
+}
+
+#elif (LINAL_SIMD == LINAL_SIMD_AVX2)
+
+constexpr const char* name = "avx2";
+
+struct pack
+{
+    __m256d v;
+};
+
+inline pack load(const real_t* p) { return { _mm256_loadu_pd(p) }; }
+inline void store(real_t* p, pack a) { _mm256_storeu_pd(p, a.v); }
+inline pack splat(real_t s) { return { _mm256_set1_pd(s) }; }
+inline pack add(pack a, pack b) { return { _mm256_add_pd(a.v, b.v) }; }
+inline pack sub(pack a, pack b) { return { _mm256_sub_pd(a.v, b.v) }; }
+inline pack mul(pack a, pack b) { return { _mm256_mul_pd(a.v, b.v) }; }
+inline pack neg(pack a) { return { _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)) }; }
+
+// Two 128-bit divisions are quicker than a 256-bit one, the pad lane is left alone (0/0 would raise FE_INVALID)
+inline pack div(pack a, pack b)
+{
+    const __m128d xy = _mm_div_pd(_mm256_castpd256_pd128(a.v), _mm256_castpd256_pd128(b.v));
+    const __m128d zw = _mm_div_sd(_mm256_extractf128_pd(a.v, 1), _mm256_extractf128_pd(b.v, 1));
+    return { _mm256_insertf128_pd(_mm256_castpd128_pd256(xy), zw, 1) };
+}
+
+inline real_t dot(pack a, pack b)
+{
+    const __m256d m = _mm256_mul_pd(a.v, b.v);
+    const __m128d xy = _mm256_castpd256_pd128(m);
+    const __m128d zw = _mm256_extractf128_pd(m, 1);
+    return _mm_cvtsd_f64(_mm_add_sd(_mm_add_sd(xy, _mm_unpackhi_pd(xy, xy)), zw));
+}
+
+#elif (LINAL_SIMD == LINAL_SIMD_SSE2)
+
+constexpr const char* name = "sse2";
+
+struct pack
+{
+    __m128d xy, zw;
+};
+
+inline pack load(const real_t* p) { return { _mm_loadu_pd(p), _mm_loadu_pd(p + 2) }; }
+inline void store(real_t* p, pack a) { _mm_storeu_pd(p, a.xy), _mm_storeu_pd(p + 2, a.zw); }
+inline pack splat(real_t s) { return { _mm_set1_pd(s), _mm_set1_pd(s) }; }
+inline pack add(pack a, pack b) { return { _mm_add_pd(a.xy, b.xy), _mm_add_pd(a.zw, b.zw) }; }
+inline pack sub(pack a, pack b) { return { _mm_sub_pd(a.xy, b.xy), _mm_sub_pd(a.zw, b.zw) }; }
+inline pack mul(pack a, pack b) { return { _mm_mul_pd(a.xy, b.xy), _mm_mul_pd(a.zw, b.zw) }; }
+inline pack neg(pack a) { return { _mm_xor_pd(a.xy, _mm_set1_pd(-0.0)), _mm_xor_pd(a.zw, _mm_set1_pd(-0.0)) }; }
+
+// The pad lane is left alone, 0/0 would raise FE_INVALID
+inline pack div(pack a, pack b) { return { _mm_div_pd(a.xy, b.xy), _mm_div_sd(a.zw, b.zw) }; }
+
+inline real_t dot(pack a, pack b)
+{
+    const __m128d xy = _mm_mul_pd(a.xy, b.xy);
+    const __m128d zw = _mm_mul_pd(a.zw, b.zw);
+    return _mm_cvtsd_f64(_mm_add_sd(_mm_add_sd(xy, _mm_unpackhi_pd(xy, xy)), zw));
+}
+
+#else
+
+constexpr const char* name = "scalar";
+
+struct pack
+{
+    real_t x, y, z, w;
+};
+
+inline pack load(const real_t* p) { return { p[0], p[1], p[2], p[3] }; }
+inline void store(real_t* p, pack a) { p[0] = a.x, p[1] = a.y, p[2] = a.z, p[3] = a.w; }
+inline pack splat(real_t s) { return { s, s, s, s }; }
+inline pack add(pack a, pack b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+inline pack sub(pack a, pack b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+inline pack mul(pack a, pack b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+inline pack neg(pack a) { return { -a.x, -a.y, -a.z, -a.w }; }
+inline pack div(pack a, pack b) { return { a.x / b.x, a.y / b.y, a.z / b.z, a.w }; }
+inline real_t dot(pack a, pack b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+#endif
+
+// 1/sqrt(sq), only used with LINAL_FAST_RSQRT, sq has to be within the float range
+inline real_t rsqrt(real_t sq)
+{
+#ifdef LINAL_FAST_RSQRT
+    real_t r = (real_t)_mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss((float)sq)));
+    for (int i = 0; i < LINAL_RSQRT_STEPS; ++i)
+    {
+        r *= (real_t)1.5 - (real_t)0.5 * sq * r * r;
+    }
+    return r;
+#else
+    return (real_t)1.0 / std::sqrt(sq);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// LINAL_LANES independent reals side by side, with masks from the comparisons.
+// Every lane is computed as the scalar code would do it, min(a, b) is a < b ? a : b
+// and max(a, b) is a > b ? a : b like the SSE instructions.
+//
+#if (LINAL_LANES == 8)
+
+struct mask { __m256 v; };
+struct lanes
+{
+    static constexpr int width = 8;
+    __m256 v;
+
+    static lanes load(const real_t* p) { return { _mm256_loadu_ps(p) }; }
+    static lanes splat(real_t s) { return { _mm256_set1_ps(s) }; }
+    void store(real_t* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline lanes operator+(lanes a, lanes b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline lanes operator-(lanes a, lanes b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline lanes operator*(lanes a, lanes b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline lanes operator/(lanes a, lanes b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline lanes sqrt(lanes a) { return { _mm256_sqrt_ps(a.v) }; }
+inline lanes min(lanes a, lanes b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline lanes max(lanes a, lanes b) { return { _mm256_max_ps(a.v, b.v) }; }
+inline lanes abs(lanes a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+inline mask operator<(lanes a, lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline mask operator<=(lanes a, lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline mask operator>(lanes a, lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline mask operator&(mask a, mask b) { return { _mm256_and_ps(a.v, b.v) }; }
+inline mask operator|(mask a, mask b) { return { _mm256_or_ps(a.v, b.v) }; }
+inline mask operator!(mask a) { return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+inline lanes select(mask m, lanes a, lanes b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+inline bool any(mask m) { return 0 != _mm256_movemask_ps(m.v); }
+inline bool all(mask m) { return 0xff == _mm256_movemask_ps(m.v); }
+inline bool lane(mask m, int i) { return 0 != (_mm256_movemask_ps(m.v) & (1 << i)); }
+
+#elif (LINAL_LANES == 4) && defined(LINAL_FLOAT)
+
+struct mask { __m128 v; };
+struct lanes
+{
+    static constexpr int width = 4;
+    __m128 v;
+
+    static lanes load(const real_t* p) { return { _mm_loadu_ps(p) }; }
+    static lanes splat(real_t s) { return { _mm_set1_ps(s) }; }
+    void store(real_t* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline lanes operator+(lanes a, lanes b) { return { _mm_add_ps(a.v, b.v) }; }
+inline lanes operator-(lanes a, lanes b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline lanes operator*(lanes a, lanes b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline lanes operator/(lanes a, lanes b) { return { _mm_div_ps(a.v, b.v) }; }
+inline lanes sqrt(lanes a) { return { _mm_sqrt_ps(a.v) }; }
+inline lanes min(lanes a, lanes b) { return { _mm_min_ps(a.v, b.v) }; }
+inline lanes max(lanes a, lanes b) { return { _mm_max_ps(a.v, b.v) }; }
+inline lanes abs(lanes a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+inline mask operator<(lanes a, lanes b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline mask operator<=(lanes a, lanes b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline mask operator>(lanes a, lanes b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline mask operator&(mask a, mask b) { return { _mm_and_ps(a.v, b.v) }; }
+inline mask operator|(mask a, mask b) { return { _mm_or_ps(a.v, b.v) }; }
+inline mask operator!(mask a) { return { _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+inline lanes select(mask m, lanes a, lanes b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+inline bool any(mask m) { return 0 != _mm_movemask_ps(m.v); }
+inline bool all(mask m) { return 0xf == _mm_movemask_ps(m.v); }
+inline bool lane(mask m, int i) { return 0 != (_mm_movemask_ps(m.v) & (1 << i)); }
+
+#elif (LINAL_LANES == 4)
+
+struct mask { __m256d v; };
+struct lanes
+{
+    static constexpr int width = 4;
+    __m256d v;
+
+    static lanes load(const real_t* p) { return { _mm256_loadu_pd(p) }; }
+    static lanes splat(real_t s) { return { _mm256_set1_pd(s) }; }
+    void store(real_t* p) const { _mm256_storeu_pd(p, v); }
+};
+
+inline lanes operator+(lanes a, lanes b) { return { _mm256_add_pd(a.v, b.v) }; }
+inline lanes operator-(lanes a, lanes b) { return { _mm256_sub_pd(a.v, b.v) }; }
+inline lanes operator*(lanes a, lanes b) { return { _mm256_mul_pd(a.v, b.v) }; }
+inline lanes operator/(lanes a, lanes b) { return { _mm256_div_pd(a.v, b.v) }; }
+inline lanes sqrt(lanes a) { return { _mm256_sqrt_pd(a.v) }; }
+inline lanes min(lanes a, lanes b) { return { _mm256_min_pd(a.v, b.v) }; }
+inline lanes max(lanes a, lanes b) { return { _mm256_max_pd(a.v, b.v) }; }
+inline lanes abs(lanes a) { return { _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v) }; }
+inline mask operator<(lanes a, lanes b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+inline mask operator<=(lanes a, lanes b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+inline mask operator>(lanes a, lanes b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+inline mask operator&(mask a, mask b) { return { _mm256_and_pd(a.v, b.v) }; }
+inline mask operator|(mask a, mask b) { return { _mm256_or_pd(a.v, b.v) }; }
+inline mask operator!(mask a) { return { _mm256_xor_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))) }; }
+inline lanes select(mask m, lanes a, lanes b) { return { _mm256_blendv_pd(b.v, a.v, m.v) }; }
+inline bool any(mask m) { return 0 != _mm256_movemask_pd(m.v); }
+inline bool all(mask m) { return 0xf == _mm256_movemask_pd(m.v); }
+inline bool lane(mask m, int i) { return 0 != (_mm256_movemask_pd(m.v) & (1 << i)); }
+
+#elif (LINAL_LANES == 2)
+
+struct mask { __m128d v; };
+struct lanes
+{
+    static constexpr int width = 2;
+    __m128d v;
+
+    static lanes load(const real_t* p) { return { _mm_loadu_pd(p) }; }
+    static lanes splat(real_t s) { return { _mm_set1_pd(s) }; }
+    void store(real_t* p) const { _mm_storeu_pd(p, v); }
+};
+
+inline lanes operator+(lanes a, lanes b) { return { _mm_add_pd(a.v, b.v) }; }
+inline lanes operator-(lanes a, lanes b) { return { _mm_sub_pd(a.v, b.v) }; }
+inline lanes operator*(lanes a, lanes b) { return { _mm_mul_pd(a.v, b.v) }; }
+inline lanes operator/(lanes a, lanes b) { return { _mm_div_pd(a.v, b.v) }; }
+inline lanes sqrt(lanes a) { return { _mm_sqrt_pd(a.v) }; }
+inline lanes min(lanes a, lanes b) { return { _mm_min_pd(a.v, b.v) }; }
+inline lanes max(lanes a, lanes b) { return { _mm_max_pd(a.v, b.v) }; }
+inline lanes abs(lanes a) { return { _mm_andnot_pd(_mm_set1_pd(-0.0), a.v) }; }
+inline mask operator<(lanes a, lanes b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+inline mask operator<=(lanes a, lanes b) { return { _mm_cmple_pd(a.v, b.v) }; }
+inline mask operator>(lanes a, lanes b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+inline mask operator&(mask a, mask b) { return { _mm_and_pd(a.v, b.v) }; }
+inline mask operator|(mask a, mask b) { return { _mm_or_pd(a.v, b.v) }; }
+inline mask operator!(mask a) { return { _mm_xor_pd(a.v, _mm_castsi128_pd(_mm_set1_epi32(-1))) }; }
+inline lanes select(mask m, lanes a, lanes b) { return { _mm_or_pd(_mm_and_pd(m.v, a.v), _mm_andnot_pd(m.v, b.v)) }; }
+inline bool any(mask m) { return 0 != _mm_movemask_pd(m.v); }
+inline bool all(mask m) { return 0x3 == _mm_movemask_pd(m.v); }
+inline bool lane(mask m, int i) { return 0 != (_mm_movemask_pd(m.v) & (1 << i)); }
+
+#else
+
+struct mask { bool v; };
+struct lanes
+{
+    static constexpr int width = 1;
+    real_t v;
+
+    static lanes load(const real_t* p) { return { *p }; }
+    static lanes splat(real_t s) { return { s }; }
+    void store(real_t* p) const { *p = v; }
+};
+
+inline lanes operator+(lanes a, lanes b) { return { a.v + b.v }; }
+inline lanes operator-(lanes a, lanes b) { return { a.v - b.v }; }
+inline lanes operator*(lanes a, lanes b) { return { a.v * b.v }; }
+inline lanes operator/(lanes a, lanes b) { return { a.v / b.v }; }
+inline lanes sqrt(lanes a) { return { std::sqrt(a.v) }; }
+inline lanes min(lanes a, lanes b) { return { (a.v < b.v) ? a.v : b.v }; }
+inline lanes max(lanes a, lanes b) { return { (a.v > b.v) ? a.v : b.v }; }
+inline lanes abs(lanes a) { return { std::abs(a.v) }; }
+inline mask operator<(lanes a, lanes b) { return { a.v < b.v }; }
+inline mask operator<=(lanes a, lanes b) { return { a.v <= b.v }; }
+inline mask operator>(lanes a, lanes b) { return { a.v > b.v }; }
+inline mask operator&(mask a, mask b) { return { a.v && b.v }; }
+inline mask operator|(mask a, mask b) { return { a.v || b.v }; }
+inline mask operator!(mask a) { return { !a.v }; }
+inline lanes select(mask m, lanes a, lanes b) { return m.v ? a : b; }
+inline bool any(mask m) { return m.v; }
+inline bool all(mask m) { return m.v; }
+inline bool lane(mask m, int) { return m.v; }
+
+#endif
+
+}
+
 struct alignas(16) vec2
 {
     real_t
@@ -34,7 +402,7 @@ struct alignas(16) vec2
         x(_x), y(_y) {}
 
     real_t len() const {
-        return sqrt(x*x + y * y);
+        return std::sqrt(x*x + y * y);
     }
 
     vec2& normalize() {
@@ -172,7 +540,18 @@ struct alignas(16) vec3
         x = 0.0,
         y = 0.0,
         z = 0.0;
+    real_t pad = 0.0;                   // fourth SIMD lane, stays zero
+
+private:
+    vec3(simd::pack p) {
+        simd::store(&x, p);
+    }
 
+    simd::pack lanes() const {
+        return simd::load(&x);
+    }
+
+public:
     vec3(){}
 
     vec3(real_t d) :
@@ -191,18 +570,27 @@ struct alignas(16) vec3
     }
 
     real_t len() const {
-        return sqrt(x*x + y * y + z * z);
+        return std::sqrt(len2());
+    }
+
+    real_t len2() const {
+        return simd::dot(lanes(), lanes());
     }
 
     vec3& normalize() {
-        real_t _len = len();
-        x /= _len, y /= _len, z /= _len;
-        return *this;
+        return (*this = normal());
     }
 
     vec3 normal() const {
-        real_t _len = len();
-        return vec3(x / _len, y / _len, z / _len);
+#ifdef LINAL_FAST_RSQRT
+        // rsqrt(0) is inf and 0 * inf in the pad lane is NaN
+        const real_t sq = len2();
+        if (0 == sq)
+            return vec3();
+        return vec3(simd::mul(lanes(), simd::splat(simd::rsqrt(sq))));
+#else
+        return vec3(simd::div(lanes(), simd::splat(len())));
+#endif
     }
 
     static vec3 normal(const vec3& v) {
@@ -218,7 +606,7 @@ struct alignas(16) vec3
     }
 
     real_t dot(const vec3& other) const {
-        return x * other.x + y * other.y + z * other.z;
+        return simd::dot(lanes(), other.lanes());
     }
 
     static real_t dot(const vec3& first, const vec3& second) {
@@ -226,7 +614,8 @@ struct alignas(16) vec3
     }
 
     vec3 project(const vec3& other) const {
-        return other.normal() * dot(other.normal());
+        const vec3 n = other.normal();
+        return n * dot(n);
     }
 
     static vec3 project(const vec3& first, const vec3& second) {
@@ -239,49 +628,46 @@ struct alignas(16) vec3
     }
 
     vec3& clamp(real_t limit) {
-        real_t div = len();
-        if (0 == div)
-            return (*this = vec3());
-        if (div <= limit)
-            return *this;
-        div /= limit;
-        x /= div, y /= div, z /= div;
-        return *this;
+        return (*this = clamp(*this, limit));
     }
 
     static vec3 clamp(const vec3& v, real_t limit) {
+#ifdef LINAL_FAST_RSQRT
+        const real_t sq = v.len2();
+        if (0 == sq)
+            return vec3();
+        if (sq <= limit * limit)
+            return vec3(v);
+        return vec3(simd::mul(v.lanes(), simd::splat(limit * simd::rsqrt(sq))));
+#else
         real_t div = v.len();
         if (0 == div)
             return vec3();
         if (div <= limit)
             return vec3(v);
         div /= limit;
-        return vec3(v.x / div, v.y / div, v.z / div);
+        return vec3(simd::div(v.lanes(), simd::splat(div)));
+#endif
     }
     
     vec3& operator-() {
-        x = -x, y = -y, z = -z;
-        return *this;
+        return (*this = vec3(simd::neg(lanes())));
     }
 
     vec3& operator+=(const vec3& other) {
-        x += other.x, y += other.y, z += other.z;
-        return *this;
+        return (*this = vec3(simd::add(lanes(), other.lanes())));
     }
 
     vec3& operator-=(const vec3& other) {
-        x -= other.x, y -= other.y, z -= other.z;
-        return *this;
+        return (*this = vec3(simd::sub(lanes(), other.lanes())));
     }
 
     vec3& operator*=(const vec3& other) {
-        x *= other.x, y *= other.y, z *= other.z;
-        return *this;
+        return (*this = vec3(simd::mul(lanes(), other.lanes())));
     }
 
     vec3& operator/=(const vec3& other) {
-        x /= other.x, y /= other.y, z /= other.z;
-        return *this;
+        return (*this = vec3(simd::div(lanes(), other.lanes())));
     }
 
     friend vec3 operator+(vec3 left, const vec3& right) {
@@ -301,13 +687,11 @@ struct alignas(16) vec3
     }
 
     vec3& operator*=(real_t v) {
-        x *= v, y *= v, z *= v;
-        return *this;
+        return (*this = vec3(simd::mul(lanes(), simd::splat(v))));
     }
 
     vec3& operator/=(real_t v) {
-        x /= v, y /= v, z /= v;
-        return *this;
+        return (*this = vec3(simd::div(lanes(), simd::splat(v))));
     }
 
     friend vec3 operator*(vec3 left, real_t v) {